@@ -6,70 +6,95 @@ uniform sampler2DArray u_TextureArraySampler;
 
 #define MAX_CASCADES 4
 
-uniform sampler2DArray u_ShadowMap;
-uniform mat4 u_LightSpaceMatrices[MAX_CASCADES];
-uniform float u_CascadeSplits[MAX_CASCADES];
-uniform int u_ShadowCascadeCount;
-uniform vec2 u_ShadowTexelSize;
-uniform float u_ShadowMinBias;
-uniform float u_ShadowSlopeBias; // reserved, not used yet
-uniform int u_ShadowPCFRadius;
+uniform sampler2DArrayShadow u_ShadowMap;
+
+// Per-frame constants shared by the world programs; mirrors World::FrameUniforms.
+layout(std140) uniform FrameUniforms {
+	mat4 u_MVPMatrix;
+	mat4 u_ViewMatrix;
+	mat4 u_LightSpaceMatrices[MAX_CASCADES];
+	vec4 u_CascadeSplits;
+	vec2 u_ShadowTexelSize;
+	float u_Daylight;
+	float u_ShadowMinBias;
+	float u_ShadowSlopeBias; // reserved, not used yet
+	int u_ShadowCascadeCount;
+	int u_ShadowPCFRadius;
+};
 
 in vec3 v_Position;
 in vec3 v_TexCoords;
 in vec3 v_Light;
 in float v_ViewDepth;
 
-float calculateShadowFactor(vec3 worldPos, float viewDepth) {
-	if (u_ShadowCascadeCount <= 0) return 1.0;
+// Share of a cascade's depth range over which it dithers into the next one.
+#define CASCADE_BLEND 0.1
 
-	int cascadeIndex = u_ShadowCascadeCount - 1;
-	for (int i = 0; i < u_ShadowCascadeCount; ++i) {
-		if (viewDepth < u_CascadeSplits[i]) {
-			cascadeIndex = i;
-			break;
-		}
-	}
+// Rotated-grid pattern; the kernel is rotated per pixel and scaled by the radius.
+const vec2 KERNEL[4] = vec2[](
+	vec2(-0.25, -0.75), vec2(0.75, -0.25), vec2(0.25, 0.75), vec2(-0.75, 0.25)
+);
 
-	vec4 lightClip = u_LightSpaceMatrices[cascadeIndex] * vec4(worldPos, 1.0);
-	vec3 lightND = lightClip.xyz / lightClip.w;
-	vec3 lightUVZ = lightND * 0.5 + 0.5;
+// Every tap on the comparison sampler is already a bilinear 2x2 PCF. Soft shadows
+// take 4 taps at any radius instead of a (2r+1)^2 grid.
+float sampleCascade(int cascade, vec3 worldPos, float angle) {
+	vec4 lightClip = u_LightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+	vec3 lightUVZ = lightClip.xyz / lightClip.w * 0.5 + 0.5;
 
 	// Outside of shadow map
-	if (lightUVZ.x < 0.0 || lightUVZ.x > 1.0 ||
-	    lightUVZ.y < 0.0 || lightUVZ.y > 1.0 ||
-	    lightUVZ.z < 0.0 || lightUVZ.z > 1.0) {
+	if (any(lessThan(lightUVZ, vec3(0.0))) || any(greaterThan(lightUVZ, vec3(1.0)))) {
 		return 1.0;
 	}
 
+	float reference = lightUVZ.z - u_ShadowMinBias;
 	int radius = u_ShadowPCFRadius;
-	if (radius <= 0) {
-		float closestDepth = texture(u_ShadowMap, vec3(lightUVZ.xy, cascadeIndex)).r;
-		float currentDepth = lightUVZ.z - u_ShadowMinBias;
-		return currentDepth <= closestDepth ? 1.0 : 0.5; // немного амбиента
-	}
+	if (radius <= 0) return texture(u_ShadowMap, vec4(lightUVZ.xy, float(cascade), reference));
 
-	float samples = 0.0;
+	float s = sin(angle);
+	float c = cos(angle);
+	mat2 rotation = mat2(c, s, -s, c);
+	vec2 scale = u_ShadowTexelSize * float(radius);
 	float visible = 0.0;
-	for (int x = -radius; x <= radius; ++x) {
-		for (int y = -radius; y <= radius; ++y) {
-			vec2 offset = vec2(x, y) * u_ShadowTexelSize;
-			float closestDepth = texture(u_ShadowMap, vec3(lightUVZ.xy + offset, cascadeIndex)).r;
-			float currentDepth = lightUVZ.z - u_ShadowMinBias;
-			if (currentDepth <= closestDepth) visible += 1.0;
-			samples += 1.0;
+	for (int i = 0; i < 4; ++i) {
+		vec2 offset = rotation * KERNEL[i] * scale;
+		visible += texture(u_ShadowMap, vec4(lightUVZ.xy + offset, float(cascade), reference));
+	}
+	return visible * 0.25;
+}
+
+float calculateShadowFactor(vec3 worldPos, float viewDepth) {
+	if (u_ShadowCascadeCount <= 0) return 1.0;
+
+	int cascadeIndex = u_ShadowCascadeCount - 1;
+	for (int i = 0; i < u_ShadowCascadeCount; ++i) {
+		if (viewDepth < u_CascadeSplits[i]) {
+			cascadeIndex = i;
+			break;
 		}
 	}
-	if (samples <= 0.0) return 1.0;
 
-	float visibility = visible / samples;
-	visibility = clamp(visibility, 0.0, 1.0);
+	// Interleaved gradient noise: a stable per-pixel rotation for the kernel.
+	float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+	float angle = noise * 6.2831853;
+
+	// Near the end of a cascade a growing share of pixels reads the next one, so the
+	// resolution change has no seam and each pixel still samples a single cascade.
+	if (cascadeIndex + 1 < u_ShadowCascadeCount) {
+		float rangeStart = cascadeIndex == 0 ? 0.0 : u_CascadeSplits[cascadeIndex - 1];
+		float rangeEnd = u_CascadeSplits[cascadeIndex];
+		float band = (rangeEnd - rangeStart) * CASCADE_BLEND;
+		float blend = (viewDepth - (rangeEnd - band)) / band;
+		if (fract(noise * 8.0) < blend) cascadeIndex++;
+	}
+	float visibility = sampleCascade(cascadeIndex, worldPos, angle);
+
+	// Hard shadows keep their darker floor (немного амбиента).
 	// Очень мягкие тени для избежания полной черноты:
 	// 0.0 -> 0.9, 1.0 -> 1.0  (диапазон [0.9, 1.0])
-	return mix(0.9, 1.0, visibility);
+	float shadowFloor = u_ShadowPCFRadius <= 0 ? 0.5 : 0.9;
+	return mix(shadowFloor, 1.0, clamp(visibility, 0.0, 1.0));
 }
 
-
 void main(void) {
 	vec4 textureColor = texture(u_TextureArraySampler, v_TexCoords);
 
@@ -2,11 +2,23 @@
 
 #define CHUNK_WIDTH 16
 #define CHUNK_LENGTH 16
+#define MAX_CASCADES 4
 
 uniform ivec2 u_ChunkPosition;
-uniform mat4 u_MVPMatrix;
-uniform mat4 u_ViewMatrix;
-uniform float u_Daylight;
+
+// Per-frame constants shared by the world programs; mirrors World::FrameUniforms.
+layout(std140) uniform FrameUniforms {
+	mat4 u_MVPMatrix;
+	mat4 u_ViewMatrix;
+	mat4 u_LightSpaceMatrices[MAX_CASCADES];
+	vec4 u_CascadeSplits;
+	vec2 u_ShadowTexelSize;
+	float u_Daylight;
+	float u_ShadowMinBias;
+	float u_ShadowSlopeBias; // reserved, not used yet
+	int u_ShadowCascadeCount;
+	int u_ShadowPCFRadius;
+};
 
 layout(location = 0) in uint a_Data0;
 layout(location = 1) in uint a_Data1;
@@ -17,6 +29,9 @@ out vec3 v_TexCoords;
 out vec3 v_Light;
 out float v_ViewDepth;
 
+// Matches depth_prepass/vert.glsl bit for bit (the colour pass may run with GL_EQUAL).
+invariant gl_Position;
+
 int decode_signed16(uint v) {
 	return int(int(v << 16) >> 16);
 }
@@ -0,0 +1,54 @@
+#version 330
+
+#define CHUNK_WIDTH 16
+#define CHUNK_LENGTH 16
+#define MAX_CASCADES 4
+
+uniform ivec2 u_ChunkPosition;
+
+// Per-frame constants shared by the world programs; mirrors World::FrameUniforms.
+layout(std140) uniform FrameUniforms {
+	mat4 u_MVPMatrix;
+	mat4 u_ViewMatrix;
+	mat4 u_LightSpaceMatrices[MAX_CASCADES];
+	vec4 u_CascadeSplits;
+	vec2 u_ShadowTexelSize;
+	float u_Daylight;
+	float u_ShadowMinBias;
+	float u_ShadowSlopeBias; // reserved, not used yet
+	int u_ShadowCascadeCount;
+	int u_ShadowPCFRadius;
+};
+
+layout(location = 0) in uint a_Data0;
+layout(location = 1) in uint a_Data1;
+layout(location = 2) in uint a_Data2;
+
+out vec3 v_TexCoords;
+
+// The colour pass tests against this depth with GL_EQUAL, so the position must be
+// computed exactly as in colored_lighting/vert.glsl.
+invariant gl_Position;
+
+int decode_signed16(uint v) {
+	return int(int(v << 16) >> 16);
+}
+
+void main(void) {
+	int px = decode_signed16(a_Data0);
+	int py = decode_signed16(a_Data0 >> 16);
+	int pz = decode_signed16(a_Data1);
+
+	float u = float((a_Data1 >> 16) & 0xFFu) / 255.0;
+	float v = float((a_Data1 >> 24) & 0xFFu) / 255.0;
+	float layer = float(a_Data2 & 0xFFu);
+
+	vec3 a_LocalPosition = vec3(px, py, pz) / 16.0;
+
+	vec3 v_Position = vec3(u_ChunkPosition.x * CHUNK_WIDTH + a_LocalPosition.x,
+						a_LocalPosition.y,
+						u_ChunkPosition.y * CHUNK_LENGTH + a_LocalPosition.z);
+	v_TexCoords = vec3(u, v, layer);
+
+	gl_Position = u_MVPMatrix * vec4(v_Position, 1.0);
+}
@@ -7,37 +7,47 @@ uniform sampler2D depthTexture;
 uniform bool u_IsUnderwater;
 uniform float u_Time;
 uniform vec2 u_ScreenSize;
-uniform float u_SSAOStrength;
+uniform sampler2D aoTexture; // r: ambient occlusion, g: linear view depth, at u_AOSize
+uniform bool u_SSAOEnabled;
+uniform vec2 u_AOSize;
+uniform vec2 u_DepthRange; // camera near, far
 
-// Lightweight depth-based SSAO (no normals)
-float calcSSAO(vec2 uv) {
-    float center = texture(depthTexture, uv).r;
-    // If depth buffer is empty (sky), skip occlusion
-    if (center >= 0.999) return 1.0;
+#define DEPTH_SHARPNESS 10.0
 
-    vec2 texel = 1.0 / u_ScreenSize;
-    float radius = 3.0;
-    float occlusion = 0.0;
-    float samples = 0.0;
+float linearDepth(float depth) {
+    return u_DepthRange.x * u_DepthRange.y / (u_DepthRange.y - depth * (u_DepthRange.y - u_DepthRange.x));
+}
 
-    // 8-tap kernel
-    vec2 offsets[8] = vec2[](
-        vec2(-1, -1), vec2(0, -1), vec2(1, -1),
-        vec2(-1,  0),              vec2(1,  0),
-        vec2(-1,  1), vec2(0,  1), vec2(1,  1)
-    );
+// Same relative depth test as the SSAO blur
+float depthWeight(float center, float depth) {
+    float relative = abs(depth - center) / center;
+    return max(0.0, 1.0 - relative * DEPTH_SHARPNESS);
+}
 
-    for (int i = 0; i < 8; i++) {
-        vec2 sampleUv = uv + offsets[i] * texel * radius;
-        float sampleDepth = texture(depthTexture, sampleUv).r;
-        // Bias to avoid self-occlusion
-        float diff = center - sampleDepth - 0.001;
-        occlusion += clamp(diff * 8.0, 0.0, 1.0);
-        samples += 1.0;
-    }
+// Bilateral upsample: bilinear weights of the four nearest AO texels, scaled down where
+// their depth differs from this pixel's so occlusion does not bleed across edges.
+float upsampleAO(vec2 uv) {
+    float depth = texture(depthTexture, uv).r;
+    if (depth >= 0.999) return 1.0;
+    float viewDepth = linearDepth(depth);
 
-    float ao = 1.0 - (occlusion / samples) * u_SSAOStrength;
-    return clamp(ao, 0.4, 1.0);
+    vec2 pos = uv * u_AOSize - 0.5;
+    vec2 base = floor(pos);
+    vec2 f = pos - base;
+    ivec2 maxTexel = ivec2(u_AOSize) - 1;
+
+    float total = 0.0;
+    float weight = 0.0;
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        vec2 s = texelFetch(aoTexture, clamp(ivec2(base) + offset, ivec2(0), maxTexel), 0).rg;
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        // The epsilon falls back to plain bilinear when every texel is rejected
+        float w = bilinear.x * bilinear.y * depthWeight(viewDepth, s.g) + 1e-4;
+        total += s.r * w;
+        weight += w;
+    }
+    return total / weight;
 }
 
 void main() {
@@ -63,8 +73,7 @@ void main() {
         col = texture(screenTexture, TexCoords).rgb;
     }
 
-    float ao = calcSSAO(TexCoords);
-    col *= ao;
+    if (u_SSAOEnabled) col *= upsampleAO(TexCoords);
 
     FragColor = vec4(col, 1.0);
 }
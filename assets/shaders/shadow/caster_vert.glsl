@@ -0,0 +1,21 @@
+#version 330 core
+
+#define CHUNK_WIDTH 16
+#define CHUNK_LENGTH 16
+
+uniform ivec2 u_ChunkPosition;
+uniform mat4 u_LightSpaceMatrix;
+
+// Chunk-local cube corner: x | y << 5 | z << 13, in whole blocks.
+layout(location = 0) in uint a_Corner;
+
+void main(void) {
+	vec3 corner = vec3(float(a_Corner & 0x1Fu), float((a_Corner >> 5) & 0xFFu), float((a_Corner >> 13) & 0x1Fu));
+	// Blocks are centred on integer coordinates.
+	vec3 local_pos = corner - 0.5;
+	vec3 world_pos = vec3(u_ChunkPosition.x * CHUNK_WIDTH + local_pos.x,
+						local_pos.y,
+						u_ChunkPosition.y * CHUNK_LENGTH + local_pos.z);
+
+	gl_Position = u_LightSpaceMatrix * vec4(world_pos, 1.0);
+}
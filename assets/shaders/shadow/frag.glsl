@@ -4,7 +4,8 @@ in vec3 v_TexCoords;
 uniform sampler2DArray u_TextureArraySampler;
 
 void main(void) {
-    // Alpha test for foliage/transparent textures
+    // Alpha test for foliage/transparent textures; same threshold as the main shader,
+    // since the depth pre-pass uses this program too
     vec4 tex = texture(u_TextureArraySampler, v_TexCoords);
-    if (tex.a < 0.5) discard;
+    if (tex.a <= 0.5) discard;
 }
@@ -0,0 +1,37 @@
+#version 330 core
+// One axis of a separable depth-aware (bilateral) blur over the AO target
+out vec2 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D aoTexture; // r: ambient occlusion, g: linear view depth (0 for sky)
+uniform vec2 u_Direction;    // one AO texel along the blur axis
+
+#define DEPTH_SHARPNESS 10.0
+
+const float WEIGHTS[4] = float[](0.2270270, 0.1945946, 0.1216216, 0.0540540);
+
+// Weight falls off with the relative difference in view distance
+float depthWeight(float center, float depth) {
+    float relative = abs(depth - center) / center;
+    return max(0.0, 1.0 - relative * DEPTH_SHARPNESS);
+}
+
+void main() {
+    vec2 center = texture(aoTexture, TexCoords).rg;
+    if (center.g <= 0.0) {
+        FragColor = center;
+        return;
+    }
+
+    float total = center.r * WEIGHTS[0];
+    float weight = WEIGHTS[0];
+    for (int i = 1; i < 4; i++) {
+        for (int side = -1; side <= 1; side += 2) {
+            vec2 s = texture(aoTexture, TexCoords + u_Direction * float(i * side)).rg;
+            float w = WEIGHTS[i] * depthWeight(center.g, s.g);
+            total += s.r * w;
+            weight += w;
+        }
+    }
+    FragColor = vec2(total / weight, center.g);
+}
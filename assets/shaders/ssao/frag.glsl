@@ -0,0 +1,47 @@
+#version 330 core
+// r: ambient occlusion, g: linear view depth of the pixel it was computed for (0 for sky)
+out vec2 FragColor;
+in vec2 TexCoords;
+
+uniform sampler2D depthTexture;
+uniform vec2 u_ScreenSize; // full resolution, the kernel radius is in screen pixels
+uniform float u_SSAOStrength;
+uniform int u_SSAOTaps;
+uniform vec2 u_DepthRange; // camera near, far
+
+// The first four taps form a cross, the last four the diagonals
+const vec2 OFFSETS[8] = vec2[](
+    vec2(-1,  0), vec2(1, 0), vec2(0, -1), vec2(0, 1),
+    vec2(-1, -1), vec2(1, -1), vec2(-1, 1), vec2(1, 1)
+);
+
+// The depth buffer value near 1.0 does not survive a half float, view distance does
+float linearDepth(float depth) {
+    return u_DepthRange.x * u_DepthRange.y / (u_DepthRange.y - depth * (u_DepthRange.y - u_DepthRange.x));
+}
+
+// Lightweight depth-based SSAO (no normals)
+void main() {
+    // Nearest filtering: each AO texel takes the depth of one full-resolution pixel
+    float center = texture(depthTexture, TexCoords).r;
+    // If depth buffer is empty (sky), skip occlusion
+    if (center >= 0.999) {
+        FragColor = vec2(1.0, 0.0);
+        return;
+    }
+
+    vec2 texel = 1.0 / u_ScreenSize;
+    float radius = 3.0;
+    float occlusion = 0.0;
+
+    for (int i = 0; i < u_SSAOTaps; i++) {
+        vec2 sampleUv = TexCoords + OFFSETS[i] * texel * radius;
+        float sampleDepth = texture(depthTexture, sampleUv).r;
+        // Bias to avoid self-occlusion
+        float diff = center - sampleDepth - 0.001;
+        occlusion += clamp(diff * 8.0, 0.0, 1.0);
+    }
+
+    float ao = 1.0 - (occlusion / float(u_SSAOTaps)) * u_SSAOStrength;
+    FragColor = vec2(clamp(ao, 0.4, 1.0), linearDepth(center));
+}
@@ -1,44 +1,78 @@
 #include "chunk.h"
 #include "../world.h"
 #include "../options.h"
+#include "../renderer/gl_state.h"
 #include <cstring>
 #include <algorithm>
-#include <tuple> // Required for std::make_tuple
+#include <bit>
 
-Chunk::Chunk(World* w, glm::ivec3 pos) : world(w), chunk_position(pos) {
-    position = glm::vec3(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT, pos.z * CHUNK_LENGTH);
-    memset(blocks, 0, sizeof(blocks));
-    memset(lightmap, 0, sizeof(lightmap));
-
-    for(int x=0; x<CHUNK_WIDTH/SUBCHUNK_WIDTH; x++)
-        for(int y=0; y<CHUNK_HEIGHT/SUBCHUNK_HEIGHT; y++)
-            for(int z=0; z<CHUNK_LENGTH/SUBCHUNK_LENGTH; z++)
-                subchunks[std::make_tuple(x,y,z)] = new Subchunk(this, {x,y,z});
+Chunk::Chunk(World* w, glm::ivec3 pos) : world(w) {
+    reset(pos);
 
 #ifndef UNIT_TEST
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    // Дадим драйверу минимум памяти, реальный размер будем выделять по факту в send_mesh_data_to_gpu
-    glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_DYNAMIC_DRAW);
-
-    size_t stride = 3 * sizeof(uint32_t);
-    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, stride, (void*)0); glEnableVertexAttribArray(0);
-    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride, (void*)(1*sizeof(uint32_t))); glEnableVertexAttribArray(1);
-    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, stride, (void*)(2*sizeof(uint32_t))); glEnableVertexAttribArray(2);
+    VertexBufferPool::Buffer buffer = world->vbo_pool.acquire(0);
+    vbo = buffer.id;
+    vbo_capacity = buffer.capacity;
+    bind_vertex_attributes();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, world->ibo);
 
+    glGenVertexArrays(1, &translucent_vao);
+    glGenBuffers(1, &translucent_ibo);
+    bind_vertex_attributes();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, translucent_ibo);
+
+    glGenVertexArrays(1, &caster_vao);
+    VertexBufferPool::Buffer casters = world->vbo_pool.acquire(0);
+    caster_vbo = casters.id;
+    caster_capacity = casters.capacity;
+    GLState::bind_vertex_array(caster_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, caster_vbo);
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0); glEnableVertexAttribArray(0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, world->ibo);
     shader_chunk_offset_loc = world->shader ? world->shader->find_uniform("u_ChunkPosition") : -1;
 #endif
 }
 
+void Chunk::reset(glm::ivec3 pos) {
+    chunk_position = pos;
+    position = glm::vec3(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT, pos.z * CHUNK_LENGTH);
+    modified = false;
+    last_edit_time = -1;
+    std::fill(std::begin(neighbors), std::end(neighbors), nullptr);
+    memset(blocks, 0, sizeof(blocks));
+    memset(lightmap, 0, sizeof(lightmap));
+
+    for(int x=0; x<SUBCHUNKS_X; x++)
+        for(int y=0; y<SUBCHUNKS_Y; y++)
+            for(int z=0; z<SUBCHUNKS_Z; z++)
+                subchunk_at(x, y, z).init(this, {x,y,z});
+
+    // The VBO keeps its allocation; nothing is drawn until the first relayout.
+    dirty_mask = 0;
+    opaque_slots = {};
+    translucent_slots = {};
+    caster_slots = {};
+    vbo_laid_out = false;
+    mesh_dirty = false;
+    mesh_quad_count = 0;
+    translucent_quad_count = 0;
+    for (auto& quads : translucent_quads) quads.clear();
+    translucent_generation = sorted_generation = 0;
+    sort_job = 0;
+    translucent_index_count = 0;
+}
+
 Chunk::~Chunk() {
 #ifndef UNIT_TEST
-    if (vao) glDeleteVertexArrays(1, &vao);
-    if (vbo) glDeleteBuffers(1, &vbo);
+    if (vao) GLState::delete_vertex_arrays(1, &vao);
+    if (translucent_vao) GLState::delete_vertex_arrays(1, &translucent_vao);
+    if (translucent_ibo) glDeleteBuffers(1, &translucent_ibo);
+    if (vbo) world->vbo_pool.release({vbo, vbo_capacity});
+    if (caster_vao) GLState::delete_vertex_arrays(1, &caster_vao);
+    if (caster_vbo) world->vbo_pool.release({caster_vbo, caster_capacity});
 #endif
-    for(auto& kv : subchunks) delete kv.second;
+    world->unlink_dirty_chunk(this);
 }
 
 int Chunk::get_block_light(glm::ivec3 pos) const { return lightmap[pos.x][pos.y][pos.z] & 0xF; }
@@ -47,6 +81,43 @@ int Chunk::get_sky_light(glm::ivec3 pos) const { return (lightmap[pos.x][pos.y][
 void Chunk::set_sky_light(glm::ivec3 pos, int v) { lightmap[pos.x][pos.y][pos.z] = (lightmap[pos.x][pos.y][pos.z] & 0xF) | (v << 4); }
 uint8_t Chunk::get_raw_light(glm::ivec3 pos) const { return lightmap[pos.x][pos.y][pos.z]; }
 
+void Chunk::set_block_id(glm::ivec3 pos, int number) {
+    const BlockProperties& props = world->block_properties;
+    bool was_emitter = props.emission(blocks[pos.x][pos.y][pos.z]) > 0;
+    bool is_emitter = props.emission(number) > 0;
+    blocks[pos.x][pos.y][pos.z] = number;
+    if (was_emitter == is_emitter) return;
+
+    Subchunk& sc = subchunk_at(pos.x / SUBCHUNK_WIDTH, pos.y / SUBCHUNK_HEIGHT, pos.z / SUBCHUNK_LENGTH);
+    uint16_t key = Subchunk::pack_emitter(pos - sc.local_position);
+    if (is_emitter) sc.emitters.push_back(key);
+    else std::erase(sc.emitters, key);
+}
+
+void Chunk::rebuild_emitter_index() {
+    const BlockProperties& props = world->block_properties;
+    for (Subchunk& sc : subchunks) sc.emitters.clear();
+    for (int lx = 0; lx < CHUNK_WIDTH; lx++) {
+        for (int ly = 0; ly < CHUNK_HEIGHT; ly++) {
+            for (int lz = 0; lz < CHUNK_LENGTH; lz++) {
+                if (props.emission(blocks[lx][ly][lz]) == 0) continue;
+                Subchunk& sc = subchunk_at(lx / SUBCHUNK_WIDTH, ly / SUBCHUNK_HEIGHT, lz / SUBCHUNK_LENGTH);
+                sc.emitters.push_back(Subchunk::pack_emitter(glm::ivec3(lx, ly, lz) - sc.local_position));
+            }
+        }
+    }
+}
+
+void Chunk::seed_emitter_light() {
+    const BlockProperties& props = world->block_properties;
+    for_each_emitter([&](glm::ivec3 lp) {
+        int emission = props.emission(blocks[lp.x][lp.y][lp.z]);
+        set_block_light(lp, emission);
+        glm::ivec3 global_pos = glm::ivec3(position) + lp;
+        world->light_increase_queue.push_back({global_pos, emission});
+    });
+}
+
 namespace {
 int get_neighbor_index(const glm::ivec3& diff) {
     if (diff == Util::EAST) return 0;
@@ -114,14 +185,61 @@ int Chunk::get_skylight_cached(glm::ivec3 global_pos) const {
 }
 
 bool Chunk::is_opaque_cached(glm::ivec3 global_pos) const {
-    int n = get_block_number_cached(global_pos);
-    if (!n) return false;
-    return !world->block_types[n]->transparent;
+    return world->block_properties.is_opaque(get_block_number_cached(global_pos));
+}
+
+int Chunk::get_voxel_cached(glm::ivec3 global_pos, uint8_t& raw_light) const {
+    glm::ivec3 cp = world->get_chunk_pos(glm::vec3(global_pos));
+    glm::ivec3 diff = cp - chunk_position;
+
+    const Chunk* src = nullptr;
+    if (diff == glm::ivec3(0)) src = this;
+    else {
+        int idx = get_neighbor_index(diff);
+        if (idx != -1) src = neighbors[idx];
+    }
+
+    if (src) {
+        glm::ivec3 lp = world->get_local_pos(glm::vec3(global_pos));
+        raw_light = src->lightmap[lp.x][lp.y][lp.z];
+        return src->blocks[lp.x][lp.y][lp.z];
+    }
+
+    raw_light = static_cast<uint8_t>(world->get_light(global_pos) | (world->get_skylight(global_pos) << 4));
+    return world->get_block_number(global_pos);
+}
+
+void Chunk::mark_subchunk_dirty(int index) {
+    dirty_mask |= 1u << index;
+    world->link_dirty_chunk(this);
+    if (world->edit_capture) world->edit_capture->push_back({this, index});
 }
 
 void Chunk::update_subchunk_meshes() {
-    chunk_update_queue.clear();
-    for(auto& kv : subchunks) chunk_update_queue.push_back(kv.second);
+    dirty_mask = (SUBCHUNK_COUNT == 32) ? ~0u : ((1u << SUBCHUNK_COUNT) - 1);
+    world->link_dirty_chunk(this);
+}
+
+void Chunk::update_border_subchunks(int dir) {
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        const Subchunk& sc = subchunks[i];
+        if (!sc.has_mesh || (sc.border_mask & (1 << dir))) mark_subchunk_dirty(i);
+    }
+}
+
+void Chunk::evict_meshes_to_cache() {
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        Subchunk& sc = subchunks[i];
+        if (!sc.has_mesh) continue;
+        // Uploaded sections only exist in the VBO and are not read back (a synchronous
+        // GPU readback on the streaming path); only meshes still waiting for upload are kept.
+        if (world->mesh_cache.enabled() && sc.staged) {
+            world->mesh_cache.put({chunk_position, i, sc.input_hash}, std::move(sc.mesh), std::move(sc.translucent_mesh),
+                                  std::move(sc.caster_mesh), sc.cutout_start, sc.border_mask, sc.missing_mask);
+        }
+        sc.has_mesh = false;
+        sc.staged = false;
+    }
 }
 
 // FIX: Robust update logic matching Python mcpy
@@ -137,13 +255,8 @@ void Chunk::update_at_position(glm::ivec3 pos) {
     int sz = z / SUBCHUNK_LENGTH;
 
     auto add_sc = [&](int _sx, int _sy, int _sz) {
-        auto key = std::make_tuple(_sx, _sy, _sz);
-        if(subchunks.count(key)) {
-            auto* sc = subchunks[key];
-            bool found = false;
-            for(auto* s : chunk_update_queue) if(s==sc) found=true;
-            if(!found) chunk_update_queue.push_back(sc);
-        }
+        if (_sx < 0 || _sx >= SUBCHUNKS_X || _sy < 0 || _sy >= SUBCHUNKS_Y || _sz < 0 || _sz >= SUBCHUNKS_Z) return;
+        mark_subchunk_dirty(subchunk_index(_sx, _sy, _sz));
     };
 
     add_sc(sx, sy, sz); // Update current subchunk
@@ -159,66 +272,396 @@ void Chunk::update_at_position(glm::ivec3 pos) {
     if (lz == 0) add_sc(sx, sy, sz - 1);
 }
 
-void Chunk::process_chunk_updates() {
-    for (int i=0; i < Options::CHUNK_UPDATES; i++) {
-        if(chunk_update_queue.empty()) break;
-        Subchunk* sc = chunk_update_queue.front();
-        chunk_update_queue.pop_front();
-        sc->update_mesh();
+void Chunk::rebuild_subchunk(int index) {
+    dirty_mask &= ~(1u << index);
+    if (subchunks[index].update_mesh()) {
         world->chunk_update_counter++;
-        if(chunk_update_queue.empty()) world->chunk_building_queue.push_back(this);
+        mesh_dirty = true;
+    } else {
+        world->mesh_rebuilds_skipped++;
+    }
+    if (!dirty_mask) {
+        world->unlink_dirty_chunk(this);
+        if (mesh_dirty) {
+            world->chunk_building_queue.push_back(this);
+            mesh_dirty = false;
+        }
+    }
+}
+
+namespace {
+// Every section gets a slot with some headroom in the chunk VBO so a local
+// edit usually fits in place. Unused space is zero-filled, which decodes to
+// degenerate quads that rasterise nothing.
+constexpr size_t QUAD_INTS = 12; // 3 uint32 per vertex * 4 vertices
+constexpr size_t SLOT_SLACK_QUADS = 16;
+constexpr size_t SLOT_ALIGN_QUADS = 32;
+
+size_t slot_capacity(size_t ints, bool always_reserve) {
+    if (!ints && !always_reserve) return 0;
+    size_t quads = ints / QUAD_INTS + SLOT_SLACK_QUADS;
+    quads = (quads + SLOT_ALIGN_QUADS - 1) / SLOT_ALIGN_QUADS * SLOT_ALIGN_QUADS;
+    return quads * QUAD_INTS;
+}
+}
+
+uint32_t Chunk::staged_sections() const {
+    uint32_t mask = 0;
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        if (subchunks[i].staged) mask |= 1u << i;
+    }
+    return mask;
+}
+
+void Chunk::release_staged(uint32_t mask) {
+    for (uint32_t m = mask; m; m &= m - 1) {
+        Subchunk& sc = subchunks[std::countr_zero(m)];
+        world->mesh_pool.release(sc.mesh);
+        world->mesh_pool.release(sc.translucent_mesh);
+        sc.staged = false;
     }
 }
 
 void Chunk::update_mesh() {
-    mesh.clear(); translucent_mesh.clear();
-    size_t mesh_total = 0;
+    uint32_t staged = staged_sections();
+    if (!staged) return;
+    if (!upload_sections(staged)) relayout(staged);
+}
+
+namespace {
+// Writes `size` ints of `data` at `offset` (in uint32s) and zero-fills the slot up to `capacity`.
+void write_slot([[maybe_unused]] GLenum target, [[maybe_unused]] size_t offset, [[maybe_unused]] size_t capacity,
+                [[maybe_unused]] const uint32_t* data, [[maybe_unused]] size_t size,
+                [[maybe_unused]] std::vector<uint32_t>& staging) {
+#ifndef UNIT_TEST
+    if (!capacity) return;
+    staging.assign(capacity, 0u);
+    if (size) std::copy(data, data + size, staging.begin());
+    glBufferSubData(target, sizeof(uint32_t) * offset, sizeof(uint32_t) * capacity, staging.data());
+#endif
+}
+}
+
+bool Chunk::upload_sections(uint32_t mask) {
+    if (!vbo_laid_out) return false;
+    for (uint32_t m = mask; m; m &= m - 1) {
+        int i = std::countr_zero(m);
+        if (subchunks[i].mesh.size() > opaque_slots[i].capacity ||
+            subchunks[i].translucent_mesh.size() > translucent_slots[i].capacity) return false;
+    }
+
+    std::vector<uint32_t> staging;
+    world->mesh_pool.acquire(staging);
+#ifndef UNIT_TEST
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+#endif
+    size_t translucent_base = static_cast<size_t>(mesh_quad_count) * QUAD_INTS;
+    bool translucent_changed = false;
+    for (uint32_t m = mask; m; m &= m - 1) {
+        int i = std::countr_zero(m);
+        const Subchunk& sc = subchunks[i];
+        SectionSlot& os = opaque_slots[i];
+        SectionSlot& ts = translucent_slots[i];
+        if (ts.used || !sc.translucent_mesh.empty()) {
+            translucent_changed = true;
+            translucent_quads[i].clear();
+            collect_translucent_quads(sc.translucent_mesh, translucent_quads[i]);
+        }
+        write_slot(GL_ARRAY_BUFFER, os.offset, os.capacity, sc.mesh.data(), sc.mesh.size(), staging);
+        write_slot(GL_ARRAY_BUFFER, translucent_base + ts.offset, ts.capacity, sc.translucent_mesh.data(), sc.translucent_mesh.size(), staging);
+        os.used = sc.mesh.size();
+        os.cutout = sc.cutout_start;
+        ts.used = sc.translucent_mesh.size();
+    }
+    world->mesh_pool.release(staging);
+    if (translucent_changed) note_translucent_change();
+    release_staged(mask);
+    upload_casters();
+    world->note_shadow_caster_change(this);
+    return true;
+}
+
+void Chunk::relayout(uint32_t staged) {
+    // Staged sections are sized by their new mesh; the rest keep what the VBO already holds.
+    std::array<SectionSlot, SUBCHUNK_COUNT> new_opaque{};
+    std::array<SectionSlot, SUBCHUNK_COUNT> new_translucent{};
+    size_t opaque_total = 0;
     size_t translucent_total = 0;
-    for (auto& kv : subchunks) {
-        mesh_total += kv.second->mesh.size();
-        translucent_total += kv.second->translucent_mesh.size();
+    bool any = false;
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        bool fresh = staged & (1u << i);
+        size_t opaque_used = fresh ? subchunks[i].mesh.size() : opaque_slots[i].used;
+        size_t translucent_used = fresh ? subchunks[i].translucent_mesh.size() : translucent_slots[i].used;
+        size_t cutout = fresh ? subchunks[i].cutout_start : opaque_slots[i].cutout;
+        new_opaque[i] = {opaque_total, slot_capacity(opaque_used, true), opaque_used, cutout};
+        new_translucent[i] = {translucent_total, slot_capacity(translucent_used, false), translucent_used};
+        opaque_total += new_opaque[i].capacity;
+        translucent_total += new_translucent[i].capacity;
+        any = any || opaque_used || translucent_used;
     }
-    if (mesh_total) mesh.reserve(mesh_total);
-    if (translucent_total) translucent_mesh.reserve(translucent_total);
+    // A chunk with no geometry at all keeps an empty buffer.
+    if (!any) opaque_total = translucent_total = 0;
+
+#ifndef UNIT_TEST
+    size_t total = opaque_total + translucent_total;
+    if (total) {
+        // Unchanged sections move GPU-side from the old buffer into a pooled one.
+        VertexBufferPool::Buffer target = world->vbo_pool.acquire(total);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, target.id);
+        glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+
+        std::vector<uint32_t> staging;
+        world->mesh_pool.acquire(staging);
+        size_t old_base = static_cast<size_t>(mesh_quad_count) * QUAD_INTS;
+        auto place = [&](const SectionSlot& from, const SectionSlot& to, size_t from_base, size_t to_base, const std::vector<uint32_t>& fresh_data, bool fresh) {
+            if (!to.capacity) return;
+            if (fresh) {
+                write_slot(GL_COPY_WRITE_BUFFER, to_base + to.offset, to.capacity, fresh_data.data(), fresh_data.size(), staging);
+                return;
+            }
+            if (to.used) {
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(uint32_t) * (from_base + from.offset),
+                                    sizeof(uint32_t) * (to_base + to.offset), sizeof(uint32_t) * to.used);
+            }
+            write_slot(GL_COPY_WRITE_BUFFER, to_base + to.offset + to.used, to.capacity - to.used, nullptr, 0, staging);
+        };
+        for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+            bool fresh = staged & (1u << i);
+            place(opaque_slots[i], new_opaque[i], 0, 0, subchunks[i].mesh, fresh);
+            place(translucent_slots[i], new_translucent[i], old_base, opaque_total, subchunks[i].translucent_mesh, fresh);
+        }
+        world->mesh_pool.release(staging);
 
-    for(auto& kv : subchunks) {
-        if(!kv.second->mesh.empty()) mesh.insert(mesh.end(), kv.second->mesh.begin(), kv.second->mesh.end());
-        if(!kv.second->translucent_mesh.empty()) translucent_mesh.insert(translucent_mesh.end(), kv.second->translucent_mesh.begin(), kv.second->translucent_mesh.end());
+        world->vbo_pool.release({vbo, vbo_capacity});
+        vbo = target.id;
+        vbo_capacity = target.capacity;
+        bind_vertex_attributes();
     }
-    mesh_quad_count = mesh.size() / 12; // 3 uint32 per vertex * 4 vertices
-    translucent_quad_count = translucent_mesh.size() / 12;
-    send_mesh_data_to_gpu();
+#endif
+
+    for (uint32_t m = staged; m; m &= m - 1) {
+        int i = std::countr_zero(m);
+        translucent_quads[i].clear();
+        collect_translucent_quads(subchunks[i].translucent_mesh, translucent_quads[i]);
+    }
+    opaque_slots = new_opaque;
+    translucent_slots = new_translucent;
+    mesh_quad_count = opaque_total / QUAD_INTS;
+    translucent_quad_count = translucent_total / QUAD_INTS;
+    vbo_laid_out = any;
+    note_translucent_change();
+    world->mesh_relayouts++;
+    release_staged(staged);
+    upload_casters();
+    world->note_shadow_caster_change(this);
 }
 
-void Chunk::send_mesh_data_to_gpu() {
-#ifdef UNIT_TEST
-    return;
+void Chunk::rebuild_sections_now(uint32_t mask) {
+    uint32_t changed = 0;
+    for (uint32_t m = mask; m; m &= m - 1) {
+        int i = std::countr_zero(m);
+        dirty_mask &= ~(1u << i);
+        if (subchunks[i].update_mesh()) changed |= 1u << i;
+    }
+    world->chunk_update_counter += std::popcount(changed);
+    if (!dirty_mask) world->unlink_dirty_chunk(this);
+    if (!changed) return;
+
+    // Background rebuilds of other sections may be staged and waiting for the chunk's
+    // last dirty section, which this call may just have cleared; they go up too.
+    uint32_t staged = staged_sections();
+    if (!upload_sections(staged)) relayout(staged);
+    mesh_dirty = false;
+    auto& queue = world->chunk_building_queue;
+    queue.erase(std::remove(queue.begin(), queue.end(), this), queue.end());
+}
+
+void Chunk::upload_casters() {
+    size_t total = 0;
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        caster_slots[i] = {total, subchunks[i].caster_mesh.size(), subchunks[i].caster_mesh.size()};
+        total += caster_slots[i].used;
+    }
+#ifndef UNIT_TEST
+    if (!total) return;
+    if (total > caster_capacity) {
+        world->vbo_pool.release({caster_vbo, caster_capacity});
+        VertexBufferPool::Buffer buffer = world->vbo_pool.acquire(total);
+        caster_vbo = buffer.id;
+        caster_capacity = buffer.capacity;
+        GLState::bind_vertex_array(caster_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, caster_vbo);
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, caster_vbo);
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        const SectionSlot& slot = caster_slots[i];
+        if (slot.used) glBufferSubData(GL_ARRAY_BUFFER, sizeof(uint32_t) * slot.offset, sizeof(uint32_t) * slot.used, subchunks[i].caster_mesh.data());
+    }
 #endif
-    size_t required_ints = mesh.size() + translucent_mesh.size();
-    if(!required_ints) { vbo_capacity = 0; return; }
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    if(required_ints != vbo_capacity) {
-        glBufferData(GL_ARRAY_BUFFER, sizeof(uint32_t)*required_ints, NULL, GL_DYNAMIC_DRAW);
-        vbo_capacity = required_ints;
+}
+
+void Chunk::bind_vertex_attributes() {
+#ifndef UNIT_TEST
+    // Both VAOs read the same VBO; they differ only in their element buffer.
+    for (GLuint array : {vao, translucent_vao}) {
+        if (!array) continue;
+        GLState::bind_vertex_array(array);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        size_t stride = 3 * sizeof(uint32_t);
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, stride, (void*)0); glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride, (void*)(1*sizeof(uint32_t))); glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, stride, (void*)(2*sizeof(uint32_t))); glEnableVertexAttribArray(2);
     }
-    if(!mesh.empty()) glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(uint32_t)*mesh.size(), mesh.data());
-    if(!translucent_mesh.empty()) glBufferSubData(GL_ARRAY_BUFFER, sizeof(uint32_t)*mesh.size(), sizeof(uint32_t)*translucent_mesh.size(), translucent_mesh.data());
+#endif
 }
 
-void Chunk::draw(GLenum mode, Shader* override_shader, int chunk_uniform) {
-#ifdef UNIT_TEST
-    return;
+void Chunk::note_translucent_change() {
+    translucent_generation = world->next_translucent_generation++;
+}
+
+void Chunk::gather_translucent_quads(std::vector<TranslucentQuad>& out) const {
+    out.clear();
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        uint32_t base = static_cast<uint32_t>(translucent_slots[i].offset / QUAD_INTS);
+        for (TranslucentQuad q : translucent_quads[i]) {
+            q.quad += base;
+            out.push_back(q);
+        }
+    }
+}
+
+void Chunk::upload_translucent_order(const std::vector<uint32_t>& indices) {
+    translucent_index_count = indices.size();
+#ifndef UNIT_TEST
+    // Through the copy target, so no VAO's element binding changes.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, translucent_ibo);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STREAM_DRAW);
 #endif
-    if(!mesh_quad_count) return;
+}
+
+bool Chunk::bind_for_draw(Shader* override_shader, int chunk_uniform) {
     Shader* active_shader = override_shader ? override_shader : world->shader;
-    if (!active_shader) return;
-    glBindVertexArray(vao);
+    if (!active_shader) return false;
+    GLState::bind_vertex_array(vao);
     int loc = chunk_uniform;
     if (loc < 0) {
         loc = override_shader ? active_shader->find_uniform("u_ChunkPosition") : shader_chunk_offset_loc;
     }
     if (loc >= 0) active_shader->setVec2i(loc, chunk_position.x, chunk_position.z);
+    return true;
+}
+
+uint32_t Chunk::opaque_section_mask() const {
+    if (!vbo_laid_out) return 0;
+    uint32_t mask = 0;
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) {
+        if (opaque_slots[i].used) mask |= 1u << i;
+    }
+    return mask;
+}
+
+void Chunk::draw_subchunks(uint32_t mask, GLenum mode, Shader* override_shader, int chunk_uniform) {
+#ifdef UNIT_TEST
+    return;
+#endif
+    mask &= opaque_section_mask();
+    if (!mask || !bind_for_draw(override_shader, chunk_uniform)) return;
+    while (mask) {
+        int first = std::countr_zero(mask);
+        int last = first + std::countr_one(mask >> first) - 1;
+        // Slots are laid out in subchunk order, so a run is one contiguous index range;
+        // the zeroed slack between slots only adds degenerate quads.
+        size_t begin = opaque_slots[first].offset / QUAD_INTS;
+        size_t end = (opaque_slots[last].offset + opaque_slots[last].used) / QUAD_INTS;
+        glDrawElements(mode, static_cast<GLsizei>((end - begin) * 6), GL_UNSIGNED_INT,
+                       reinterpret_cast<void*>(begin * 6 * sizeof(GLuint)));
+        mask &= ~((2u << last) - 1);
+    }
+}
+
+void Chunk::draw_casters(uint32_t mask, Shader* caster_shader, int chunk_uniform) {
+#ifdef UNIT_TEST
+    return;
+#endif
+    if (!mask || !caster_shader) return;
+    GLState::bind_vertex_array(caster_vao);
+    if (chunk_uniform >= 0) caster_shader->setVec2i(chunk_uniform, chunk_position.x, chunk_position.z);
+    while (mask) {
+        int first = std::countr_zero(mask);
+        int last = first + std::countr_one(mask >> first) - 1;
+        // Four uint32 vertices per quad, packed without padding between sections.
+        size_t begin = caster_slots[first].offset / 4;
+        size_t end = (caster_slots[last].offset + caster_slots[last].used) / 4;
+        if (end > begin) {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>((end - begin) * 6), GL_UNSIGNED_INT,
+                           reinterpret_cast<void*>(begin * 6 * sizeof(GLuint)));
+        }
+        mask &= ~((2u << last) - 1);
+    }
+}
+
+void Chunk::draw_cutouts(uint32_t mask, GLenum mode, Shader* override_shader, int chunk_uniform) {
+#ifdef UNIT_TEST
+    return;
+#endif
+    mask &= opaque_section_mask();
+    bool bound = false;
+    for (; mask; mask &= mask - 1) {
+        const SectionSlot& slot = opaque_slots[std::countr_zero(mask)];
+        if (slot.cutout >= slot.used) continue;
+        if (!bound && !(bound = bind_for_draw(override_shader, chunk_uniform))) return;
+        size_t begin = (slot.offset + slot.cutout) / QUAD_INTS;
+        size_t end = (slot.offset + slot.used) / QUAD_INTS;
+        glDrawElements(mode, static_cast<GLsizei>((end - begin) * 6), GL_UNSIGNED_INT,
+                       reinterpret_cast<void*>(begin * 6 * sizeof(GLuint)));
+    }
+}
+
+void Chunk::draw_solids(uint32_t mask, GLenum mode, Shader* override_shader, int chunk_uniform) {
+#ifdef UNIT_TEST
+    return;
+#endif
+    mask &= opaque_section_mask();
+    bool bound = false;
+    size_t run_begin = 0, run_end = 0;
+    int run_last = -2;
+    bool run_open = false; // the last section of the run has no cutout tail, so the run may grow
+    auto flush = [&]() {
+        if (run_end > run_begin) {
+            glDrawElements(mode, static_cast<GLsizei>((run_end - run_begin) * 6), GL_UNSIGNED_INT,
+                           reinterpret_cast<void*>(run_begin * 6 * sizeof(GLuint)));
+        }
+        run_begin = run_end = 0;
+    };
+    for (; mask; mask &= mask - 1) {
+        int i = std::countr_zero(mask);
+        const SectionSlot& slot = opaque_slots[i];
+        size_t begin = slot.offset / QUAD_INTS;
+        size_t end = (slot.offset + slot.cutout) / QUAD_INTS;
+        if (end > begin) {
+            if (!bound && !(bound = bind_for_draw(override_shader, chunk_uniform))) return;
+            // Like draw_subchunks, adjacent sections join one draw over the zeroed slack.
+            if (run_open && run_last == i - 1) {
+                run_end = end;
+            } else {
+                flush();
+                run_begin = begin;
+                run_end = end;
+            }
+        }
+        run_last = i;
+        run_open = end > begin && slot.cutout >= slot.used;
+    }
+    flush();
+}
+
+void Chunk::draw(GLenum mode, Shader* override_shader, int chunk_uniform) {
+#ifdef UNIT_TEST
+    return;
+#endif
+    if(!mesh_quad_count) return;
+    if (!bind_for_draw(override_shader, chunk_uniform)) return;
     glDrawElements(mode, mesh_quad_count * 6, GL_UNSIGNED_INT, 0);
 }
 
@@ -227,13 +670,12 @@ void Chunk::draw_translucent(GLenum mode, Shader* override_shader, int chunk_uni
     return;
 #endif
     if(!translucent_quad_count) return;
-    Shader* active_shader = override_shader ? override_shader : world->shader;
-    if (!active_shader) return;
-    glBindVertexArray(vao);
-    int loc = chunk_uniform;
-    if (loc < 0) {
-        loc = override_shader ? active_shader->find_uniform("u_ChunkPosition") : shader_chunk_offset_loc;
+    if (!bind_for_draw(override_shader, chunk_uniform)) return;
+    if (sorted_generation == translucent_generation && translucent_index_count) {
+        GLState::bind_vertex_array(translucent_vao);
+        glDrawElementsBaseVertex(mode, static_cast<GLsizei>(translucent_index_count), GL_UNSIGNED_INT, 0, mesh_quad_count * 4);
+        return;
     }
-    if (loc >= 0) active_shader->setVec2i(loc, chunk_position.x, chunk_position.z);
+    // No current order yet: mesh-build order until the worker catches up.
     glDrawElementsBaseVertex(mode, translucent_quad_count * 6, GL_UNSIGNED_INT, 0, mesh_quad_count * 4);
 }
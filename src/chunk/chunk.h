@@ -1,12 +1,11 @@
 #pragma once
 #include <vector>
-#include <deque>
-#include <map>
-#include <tuple>
+#include <array>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 #include <cstdint>
 #include "subchunk.h"
+#include "translucent_sorter.h"
 #include "../util.h"
 #include "../renderer/shader.h"
 
@@ -16,31 +15,86 @@ const int CHUNK_WIDTH = 16;
 const int CHUNK_HEIGHT = 128;
 const int CHUNK_LENGTH = 16;
 
+const int SUBCHUNKS_X = CHUNK_WIDTH / SUBCHUNK_WIDTH;
+const int SUBCHUNKS_Y = CHUNK_HEIGHT / SUBCHUNK_HEIGHT;
+const int SUBCHUNKS_Z = CHUNK_LENGTH / SUBCHUNK_LENGTH;
+const int SUBCHUNK_COUNT = SUBCHUNKS_X * SUBCHUNKS_Y * SUBCHUNKS_Z;
+static_assert(SUBCHUNK_COUNT <= 32, "dirty_mask holds one bit per subchunk");
+
 class Chunk {
 public:
     World* world;
     glm::ivec3 chunk_position;
     glm::vec3 position;
     bool modified = false;
+    long last_edit_time = -1; // World::time of the last set_block in this chunk
     Chunk* neighbors[6] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
 
     uint8_t blocks[CHUNK_WIDTH][CHUNK_HEIGHT][CHUNK_LENGTH];
     uint8_t lightmap[CHUNK_WIDTH][CHUNK_HEIGHT][CHUNK_LENGTH];
 
-    std::map<std::tuple<int, int, int>, Subchunk*> subchunks;
-    std::deque<Subchunk*> chunk_update_queue;
+    std::array<Subchunk, SUBCHUNK_COUNT> subchunks; // indexed by subchunk_index()
+    uint32_t dirty_mask = 0;                        // subchunks waiting for a rebuild
+
+    // Intrusive links for World's list of chunks with a non-zero dirty_mask.
+    Chunk* dirty_prev = nullptr;
+    Chunk* dirty_next = nullptr;
+    bool in_dirty_list = false;
 
-    std::vector<uint32_t> mesh;
-    std::vector<uint32_t> translucent_mesh;
+    // Where each section lives in the VBO, in uint32s: opaque slots from the start,
+    // translucent slots after the opaque region (mesh_quad_count quads). `used` is
+    // the section's geometry, the rest of the slot is zero padding. There is no CPU
+    // copy of the VBO; partial updates re-derive from the freshly built subchunk.
+    // Opaque slots also record `cutout`, where the section's alpha-tested faces start.
+    struct SectionSlot { size_t offset = 0; size_t capacity = 0; size_t used = 0; size_t cutout = 0; };
+    std::array<SectionSlot, SUBCHUNK_COUNT> opaque_slots{};
+    std::array<SectionSlot, SUBCHUNK_COUNT> translucent_slots{};
+    bool vbo_laid_out = false;
+    bool mesh_dirty = false; // a subchunk mesh changed since the last upload
     int mesh_quad_count = 0;
     int translucent_quad_count = 0;
 
     GLuint vao = 0, vbo = 0;
-    size_t vbo_capacity = 0;
+    size_t vbo_capacity = 0; // allocated size of vbo in uint32s (may exceed the layout)
+
+    // Back-to-front translucent order: per-section quad centroids, and a second VAO over
+    // the same VBO whose element buffer holds the order last sorted by World's worker.
+    // translucent_generation changes (to a world-unique value) whenever the translucent
+    // quads move; an order only draws while it matches.
+    std::array<std::vector<TranslucentQuad>, SUBCHUNK_COUNT> translucent_quads;
+    uint32_t translucent_generation = 0;
+    uint32_t sorted_generation = 0;
+    uint64_t sort_job = 0; // in-flight TranslucentSorter job, 0 if none
+    glm::vec3 sort_eye{0.0f};
+    GLuint translucent_vao = 0, translucent_ibo = 0;
+    size_t translucent_index_count = 0;
+
+    // Shadow caster stream: every section's caster_mesh back to back in a separate
+    // position-only buffer (capacity == used), rewritten whenever a section uploads.
+    std::array<SectionSlot, SUBCHUNK_COUNT> caster_slots{};
+    GLuint caster_vao = 0, caster_vbo = 0;
+    size_t caster_capacity = 0; // in uint32s
     int shader_chunk_offset_loc = -1;
 
     Chunk(World* w, glm::ivec3 pos);
     ~Chunk();
+    // Re-binds a pooled chunk to a new position with empty blocks, light and meshes.
+    void reset(glm::ivec3 pos);
+
+    static int subchunk_index(int sx, int sy, int sz) { return (sx * SUBCHUNKS_Y + sy) * SUBCHUNKS_Z + sz; }
+    Subchunk& subchunk_at(int sx, int sy, int sz) { return subchunks[subchunk_index(sx, sy, sz)]; }
+    void mark_subchunk_dirty(int index);
+
+    // Writes a block id and keeps the subchunk emitter lists in step.
+    void set_block_id(glm::ivec3 pos, int number);
+    // Rescans the block array for emitters (old saves without an index, legacy files).
+    void rebuild_emitter_index();
+    // Lights every indexed emitter and queues it for propagation.
+    void seed_emitter_light();
+    template <typename F> void for_each_emitter(F&& f) const {
+        for (const Subchunk& sc : subchunks)
+            for (uint16_t e : sc.emitters) f(sc.local_position + Subchunk::unpack_emitter(e));
+    }
 
     int get_block_light(glm::ivec3 pos) const;
     void set_block_light(glm::ivec3 pos, int value);
@@ -51,12 +105,46 @@ public:
     int get_light_cached(glm::ivec3 global_pos) const;
     int get_skylight_cached(glm::ivec3 global_pos) const;
     bool is_opaque_cached(glm::ivec3 global_pos) const;
+    // Block id and packed light byte (block | sky << 4) in one lookup.
+    int get_voxel_cached(glm::ivec3 global_pos, uint8_t& raw_light) const;
 
     void update_subchunk_meshes();
+    // Requeues only the subchunks whose mesh reads across the edge in direction `dir` (Util::DIRECTIONS index).
+    void update_border_subchunks(int dir);
+    // Hands meshes not yet uploaded to World::mesh_cache before the chunk is unloaded.
+    void evict_meshes_to_cache();
     void update_at_position(glm::ivec3 pos);
-    void process_chunk_updates();
+    // Rebuilds one dirty subchunk; queues the chunk for upload once none are left.
+    void rebuild_subchunk(int index);
+    // Uploads every staged section and hands its buffers back to the pool.
     void update_mesh();
-    void send_mesh_data_to_gpu();
+    // Rewrites only the given sections' slots in place; false if one no longer fits.
+    bool upload_sections(uint32_t mask);
+    // New VBO layout: staged sections are written, the others copied over GPU-side.
+    void relayout(uint32_t staged);
+    // Fast lane for player edits: rebuilds the given sections and uploads them right away.
+    void rebuild_sections_now(uint32_t mask);
+    uint32_t staged_sections() const;
     void draw(GLenum mode, Shader* override_shader = nullptr, int chunk_uniform = -1);
     void draw_translucent(GLenum mode, Shader* override_shader = nullptr, int chunk_uniform = -1);
+    // Copies the centroids of every translucent quad, indexed within the translucent region.
+    void gather_translucent_quads(std::vector<TranslucentQuad>& out) const;
+    void upload_translucent_order(const std::vector<uint32_t>& indices);
+    // Opaque geometry of the subchunks in `mask` only; runs of adjacent sections go out as one draw.
+    void draw_subchunks(uint32_t mask, GLenum mode, Shader* override_shader = nullptr, int chunk_uniform = -1);
+    // Subchunks with opaque quads in the current VBO layout.
+    uint32_t opaque_section_mask() const;
+    // Shadow pass: merged solid-cube depth quads, and the alpha-tested rest of the opaque geometry.
+    void draw_casters(uint32_t mask, Shader* caster_shader, int chunk_uniform);
+    void draw_cutouts(uint32_t mask, GLenum mode, Shader* override_shader, int chunk_uniform);
+    // The opaque faces that need no alpha test, i.e. every opaque face before each slot's `cutout`.
+    void draw_solids(uint32_t mask, GLenum mode, Shader* override_shader, int chunk_uniform);
+
+private:
+    void release_staged(uint32_t mask);
+    void bind_vertex_attributes();
+    void upload_casters();
+    void note_translucent_change();
+    // Binds the VAO and sets the chunk offset uniform; false if there is no shader to draw with.
+    bool bind_for_draw(Shader* override_shader, int chunk_uniform);
 };
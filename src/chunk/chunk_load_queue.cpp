@@ -0,0 +1,75 @@
+#include "chunk_load_queue.h"
+#include "chunk.h"
+#include "../entity/player.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+// std heap functions build a max-heap; invert so the lowest score is on top.
+bool ChunkLoadQueue::later(const Entry& a, const Entry& b) {
+    if (a.tier != b.tier) return a.tier > b.tier;
+    return a.score > b.score;
+}
+
+bool ChunkLoadQueue::push(const glm::ivec3& pos) {
+    if (!queued.insert(pos).second) return false;
+    heap.push_back(score(pos));
+    std::push_heap(heap.begin(), heap.end(), later);
+    return true;
+}
+
+bool ChunkLoadQueue::pop(glm::ivec3& pos) {
+    if (heap.empty()) return false;
+    std::pop_heap(heap.begin(), heap.end(), later);
+    pos = heap.back().pos;
+    heap.pop_back();
+    queued.erase(pos);
+    return true;
+}
+
+void ChunkLoadQueue::clear() {
+    heap.clear();
+    queued.clear();
+}
+
+void ChunkLoadQueue::update_viewer(const Viewer& v) {
+    glm::vec2 moved(v.position.x - viewer.position.x, v.position.z - viewer.position.z);
+    float turned = std::abs(std::remainder(v.yaw - viewer.yaw, 2.0f * glm::pi<float>()));
+    bool same = glm::dot(moved, moved) < RESCORE_DISTANCE * RESCORE_DISTANCE &&
+                turned < RESCORE_YAW && v.has_view == viewer.has_view &&
+                glm::distance(v.velocity, viewer.velocity) < RESCORE_DISTANCE;
+    if (same) return;
+    rescore(v);
+}
+
+void ChunkLoadQueue::rescore(const Viewer& v) {
+    viewer = v;
+    for (Entry& e : heap) e = score(e.pos);
+    make_heap();
+    rescores++;
+}
+
+ChunkLoadQueue::Entry ChunkLoadQueue::score(const glm::ivec3& pos) const {
+    glm::vec2 center((pos.x + 0.5f) * CHUNK_WIDTH, (pos.z + 0.5f) * CHUNK_LENGTH);
+    glm::vec2 here(viewer.position.x, viewer.position.z);
+    glm::vec2 ahead = here + glm::vec2(viewer.velocity.x, viewer.velocity.z) * LOOKAHEAD_SECONDS;
+
+    int tier = 2;
+    glm::ivec2 here_chunk(static_cast<int>(std::floor(here.x / CHUNK_WIDTH)), static_cast<int>(std::floor(here.y / CHUNK_LENGTH)));
+    if (std::abs(pos.x - here_chunk.x) <= 1 && std::abs(pos.z - here_chunk.y) <= 1) tier = 0;
+    else if (viewer.frustum && viewer.frustum->check_in_frustum(pos)) tier = 1;
+
+    float weight = 1.0f;
+    glm::vec2 to_chunk = center - here;
+    if (viewer.has_view && glm::dot(to_chunk, to_chunk) > 0.0f) {
+        // Same forward vector the player's movement uses for yaw.
+        glm::vec2 forward(std::cos(viewer.yaw), std::sin(viewer.yaw));
+        float facing = glm::dot(forward, glm::normalize(to_chunk));
+        weight += (BEHIND_WEIGHT - 1.0f) * (1.0f - facing) * 0.5f;
+    }
+    return {tier, glm::distance(center, ahead) * weight, pos};
+}
+
+void ChunkLoadQueue::make_heap() {
+    std::make_heap(heap.begin(), heap.end(), later);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../util.h"
+
+class Player;
+
+// Pending chunk loads kept as a min-heap on a look-ahead score, with a hash set
+// for O(1) duplicate checks. Order: the player's own 3x3 chunks, then chunks in
+// the view frustum, then everything else; within a tier, chunks near where the
+// player will be (position + velocity * LOOKAHEAD_SECONDS) and near the view
+// direction come first.
+class ChunkLoadQueue {
+public:
+    static constexpr float LOOKAHEAD_SECONDS = 3.0f;
+    // Distance multiplier for a chunk straight behind the view direction.
+    static constexpr float BEHIND_WEIGHT = 2.0f;
+    // Viewer changes below these leave the current order alone.
+    static constexpr float RESCORE_DISTANCE = 4.0f;
+    static constexpr float RESCORE_YAW = 0.25f;
+
+    struct Viewer {
+        glm::vec3 position{0.0f};
+        glm::vec3 velocity{0.0f};
+        float yaw = 0.0f;
+        bool has_view = false;
+        // Frustum test source; chunks skip the frustum tier when null.
+        Player* frustum = nullptr;
+    };
+
+    // Returns false if the chunk was already queued.
+    bool push(const glm::ivec3& pos);
+    bool pop(glm::ivec3& pos);
+    bool contains(const glm::ivec3& pos) const { return queued.count(pos) != 0; }
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    void clear();
+
+    // Re-scores everything when the viewer moved or turned past the thresholds.
+    void update_viewer(const Viewer& v);
+    void rescore(const Viewer& v);
+
+    template <typename Pred>
+    void remove_if(Pred pred) {
+        size_t kept = 0;
+        for (const Entry& e : heap) {
+            if (pred(e.pos)) queued.erase(e.pos);
+            else heap[kept++] = e;
+        }
+        if (kept == heap.size()) return;
+        heap.resize(kept);
+        make_heap();
+    }
+
+    int rescores = 0;
+
+private:
+    struct Entry {
+        int tier;
+        float score;
+        glm::ivec3 pos;
+    };
+
+    static bool later(const Entry& a, const Entry& b);
+    Entry score(const glm::ivec3& pos) const;
+    void make_heap();
+
+    Viewer viewer;
+    std::vector<Entry> heap;
+    std::unordered_set<glm::ivec3, Util::IVec3Hash> queued;
+};
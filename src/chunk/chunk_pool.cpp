@@ -0,0 +1,33 @@
+#include "chunk_pool.h"
+#include "../world.h"
+
+ChunkPool::~ChunkPool() {
+    clear();
+}
+
+Chunk* ChunkPool::acquire(glm::ivec3 pos) {
+    if (free_chunks.empty()) {
+        allocations++;
+        return new Chunk(world, pos);
+    }
+    Chunk* c = free_chunks.back();
+    free_chunks.pop_back();
+    c->reset(pos);
+    return c;
+}
+
+void ChunkPool::release(Chunk* chunk) {
+    world->unlink_dirty_chunk(chunk);
+    // Its geometry may still be in cached shadow maps.
+    if (chunk->vbo_laid_out) world->note_shadow_caster_change(chunk);
+    if (free_chunks.size() >= MAX_POOLED) {
+        delete chunk;
+        return;
+    }
+    free_chunks.push_back(chunk);
+}
+
+void ChunkPool::clear() {
+    for (Chunk* c : free_chunks) delete c;
+    free_chunks.clear();
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Chunk;
+class World;
+
+// Unloaded chunks are parked here and re-bound to a new position instead of
+// being deleted, so streaming reuses their block/light arrays, subchunks,
+// VAO and VBO (with its allocated size) rather than allocating fresh ones.
+class ChunkPool {
+public:
+    static constexpr size_t MAX_POOLED = 64;
+
+    explicit ChunkPool(World* w) : world(w) {}
+    ~ChunkPool();
+
+    Chunk* acquire(glm::ivec3 pos);
+    // The chunk must already be out of World::chunks and the world's queues.
+    void release(Chunk* chunk);
+    void clear();
+
+    size_t size() const { return free_chunks.size(); }
+    uint64_t allocations = 0; // chunks created with new
+
+private:
+    World* world;
+    std::vector<Chunk*> free_chunks;
+};
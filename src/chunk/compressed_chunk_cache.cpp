@@ -0,0 +1,68 @@
+#include "compressed_chunk_cache.h"
+#include <zlib.h>
+#include <cstring>
+
+namespace {
+constexpr size_t RAW_SIZE = sizeof(Chunk::blocks) + sizeof(Chunk::lightmap);
+}
+
+void CompressedChunkCache::set_budget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+void CompressedChunkCache::put(const Chunk& chunk) {
+    if (!budget) return;
+    auto it = index.find(chunk.chunk_position);
+    if (it != index.end()) erase(it->second);
+
+    std::vector<uint8_t> raw(RAW_SIZE);
+    std::memcpy(raw.data(), chunk.blocks, sizeof(chunk.blocks));
+    std::memcpy(raw.data() + sizeof(chunk.blocks), chunk.lightmap, sizeof(chunk.lightmap));
+
+    uLongf packed_size = compressBound(RAW_SIZE);
+    std::vector<uint8_t> packed(packed_size);
+    // Level 1: mostly air and long stone runs compress well even at the fastest setting.
+    if (compress2(packed.data(), &packed_size, raw.data(), RAW_SIZE, 1) != Z_OK) return;
+    packed.resize(packed_size);
+    packed.shrink_to_fit();
+
+    Entry entry{chunk.chunk_position, chunk.modified, std::move(packed), {}};
+    for (int i = 0; i < SUBCHUNK_COUNT; i++) entry.emitters[i] = chunk.subchunks[i].emitters;
+    used += entry.data.size();
+    entries.push_front(std::move(entry));
+    index[chunk.chunk_position] = entries.begin();
+    trim();
+}
+
+bool CompressedChunkCache::take(const glm::ivec3& pos, Chunk& chunk) {
+    auto it = index.find(pos);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    const Entry& entry = *it->second;
+    std::vector<uint8_t> raw(RAW_SIZE);
+    uLongf raw_size = RAW_SIZE;
+    bool ok = uncompress(raw.data(), &raw_size, entry.data.data(), entry.data.size()) == Z_OK && raw_size == RAW_SIZE;
+    if (ok) {
+        std::memcpy(chunk.blocks, raw.data(), sizeof(chunk.blocks));
+        std::memcpy(chunk.lightmap, raw.data() + sizeof(chunk.blocks), sizeof(chunk.lightmap));
+        for (int i = 0; i < SUBCHUNK_COUNT; i++) chunk.subchunks[i].emitters = std::move(it->second->emitters[i]);
+        chunk.modified = entry.modified;
+    }
+    erase(it->second);
+    if (ok) hits++;
+    else misses++;
+    return ok;
+}
+
+void CompressedChunkCache::erase(std::list<Entry>::iterator it) {
+    used -= it->data.size();
+    index.erase(it->pos);
+    entries.erase(it);
+}
+
+void CompressedChunkCache::trim() {
+    while (!entries.empty() && used > budget) erase(std::prev(entries.end()));
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "chunk.h"
+
+// LRU of unloaded chunks' blocks and light, zlib-compressed and bounded by a
+// byte budget. A chunk that streams back in while still cached is restored
+// without touching the disk or relighting it from scratch.
+class CompressedChunkCache {
+public:
+    // Budget in compressed bytes; 0 disables the cache.
+    void set_budget(size_t bytes);
+    size_t size() const { return entries.size(); }
+    size_t bytes_used() const { return used; }
+
+    void put(const Chunk& chunk);
+    // Restores blocks, lightmap, emitter index and the modified flag into `chunk`; the entry is removed.
+    bool take(const glm::ivec3& pos, Chunk& chunk);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+private:
+    struct Entry {
+        glm::ivec3 pos;
+        bool modified;
+        std::vector<uint8_t> data; // compressed blocks followed by lightmap
+        std::array<std::vector<uint16_t>, SUBCHUNK_COUNT> emitters;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+    void trim();
+
+    size_t budget = 0;
+    size_t used = 0;
+    std::list<Entry> entries; // front = most recently used
+    std::unordered_map<glm::ivec3, std::list<Entry>::iterator, Util::IVec3Hash> index;
+};
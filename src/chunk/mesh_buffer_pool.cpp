@@ -0,0 +1,20 @@
+#include "mesh_buffer_pool.h"
+
+void MeshBufferPool::acquire(std::vector<uint32_t>& buf) {
+    if (free_buffers.empty()) {
+        buf.clear();
+        return;
+    }
+    buf.swap(free_buffers.back());
+    free_buffers.pop_back();
+    pooled_bytes -= buf.capacity() * sizeof(uint32_t);
+    buf.clear();
+}
+
+void MeshBufferPool::release(std::vector<uint32_t>& buf) {
+    std::vector<uint32_t> taken;
+    taken.swap(buf);
+    if (!taken.capacity() || free_buffers.size() >= MAX_POOLED) return;
+    pooled_bytes += taken.capacity() * sizeof(uint32_t);
+    free_buffers.push_back(std::move(taken));
+}
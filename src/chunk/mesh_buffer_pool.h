@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Recycled vertex buffers for meshing and upload staging. Subchunk meshes only
+// live on the CPU between the mesher and the upload; afterwards the buffers
+// come back here instead of staying attached to the subchunk.
+class MeshBufferPool {
+public:
+    static constexpr size_t MAX_POOLED = 16;
+
+    // Swaps a cleared pooled buffer (or a fresh one) into `buf`.
+    void acquire(std::vector<uint32_t>& buf);
+    // Takes the buffer's storage and leaves `buf` empty with no capacity.
+    void release(std::vector<uint32_t>& buf);
+
+    size_t size() const { return free_buffers.size(); }
+    size_t bytes() const { return pooled_bytes; }
+
+private:
+    std::vector<std::vector<uint32_t>> free_buffers;
+    size_t pooled_bytes = 0;
+};
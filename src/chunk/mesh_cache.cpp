@@ -0,0 +1,46 @@
+#include "mesh_cache.h"
+
+void MeshCache::set_capacity(size_t n) {
+    capacity = n;
+    trim();
+}
+
+void MeshCache::put(const Key& key, std::vector<uint32_t>&& mesh, std::vector<uint32_t>&& translucent_mesh,
+                    std::vector<uint32_t>&& caster_mesh, size_t cutout_start, uint8_t border_mask, uint8_t missing_mask) {
+    if (!capacity) return;
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front({key, std::move(mesh), std::move(translucent_mesh), std::move(caster_mesh), cutout_start,
+                        border_mask, missing_mask});
+    index[key] = entries.begin();
+    trim();
+}
+
+bool MeshCache::take(const Key& key, std::vector<uint32_t>& mesh, std::vector<uint32_t>& translucent_mesh,
+                     std::vector<uint32_t>& caster_mesh, size_t& cutout_start, uint8_t& border_mask, uint8_t& missing_mask) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    mesh = std::move(it->second->mesh);
+    translucent_mesh = std::move(it->second->translucent_mesh);
+    caster_mesh = std::move(it->second->caster_mesh);
+    cutout_start = it->second->cutout_start;
+    border_mask = it->second->border_mask;
+    missing_mask = it->second->missing_mask;
+    entries.erase(it->second);
+    index.erase(it);
+    hits++;
+    return true;
+}
+
+void MeshCache::trim() {
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
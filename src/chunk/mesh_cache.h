@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// LRU of subchunk meshes from unloaded chunks, keyed by chunk position,
+// subchunk index and the subchunk's input hash. A chunk that streams back in
+// unchanged reuses its old meshes instead of running the mesher again. Only meshes
+// that were still waiting for upload are cached; uploaded ones are never read back.
+class MeshCache {
+public:
+    struct Key {
+        glm::ivec3 chunk;
+        int subchunk;
+        uint64_t input_hash;
+        bool operator==(const Key& o) const {
+            return chunk == o.chunk && subchunk == o.subchunk && input_hash == o.input_hash;
+        }
+    };
+
+    // Capacity in subchunk meshes; 0 disables the cache.
+    void set_capacity(size_t entries);
+    size_t size() const { return entries.size(); }
+    bool enabled() const { return capacity > 0; }
+
+    // The edge masks travel with the mesh: a cached mesh may still have faces missing
+    // towards a neighbour that was not loaded when it was built.
+    void put(const Key& key, std::vector<uint32_t>&& mesh, std::vector<uint32_t>&& translucent_mesh,
+             std::vector<uint32_t>&& caster_mesh, size_t cutout_start, uint8_t border_mask, uint8_t missing_mask);
+    // Moves the cached meshes out on a hit; the entry is removed.
+    bool take(const Key& key, std::vector<uint32_t>& mesh, std::vector<uint32_t>& translucent_mesh,
+              std::vector<uint32_t>& caster_mesh, size_t& cutout_start, uint8_t& border_mask, uint8_t& missing_mask);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+private:
+    struct Entry {
+        Key key;
+        std::vector<uint32_t> mesh;
+        std::vector<uint32_t> translucent_mesh;
+        std::vector<uint32_t> caster_mesh;
+        size_t cutout_start;
+        uint8_t border_mask;
+        uint8_t missing_mask;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h = static_cast<size_t>(k.input_hash);
+            h ^= std::hash<int>()(k.chunk.x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()(k.chunk.z) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()(k.subchunk) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    void trim();
+
+    size_t capacity = 0;
+    std::list<Entry> entries; // front = most recently used
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+};
@@ -0,0 +1,53 @@
+#include "remesh_scheduler.h"
+#include "../world.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <glm/gtx/norm.hpp>
+
+void RemeshScheduler::run(int64_t budget_us) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto over_budget = [&]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() >= budget_us;
+    };
+
+    Player* player = world->player;
+    glm::vec3 camera = player ? player->position : glm::vec3(0.0f);
+    const glm::vec3 half_section(SUBCHUNK_WIDTH * 0.5f, SUBCHUNK_HEIGHT * 0.5f, SUBCHUNK_LENGTH * 0.5f);
+
+    candidates.clear();
+    for (Chunk* c = world->dirty_chunks_head; c; c = c->dirty_next) {
+        int tier = 2;
+        if (c->last_edit_time >= 0 && world->time - c->last_edit_time <= EDIT_RECENCY_TICKS) tier = 0;
+        else if (!player || player->check_in_frustum(c->chunk_position)) tier = 1;
+
+        for (uint32_t mask = c->dirty_mask; mask; mask &= mask - 1) {
+            int index = std::countr_zero(mask);
+            glm::vec3 center = c->subchunks[index].position + half_section;
+            candidates.push_back({tier, glm::length2(center - camera), c, index});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.tier != b.tier) return a.tier < b.tier;
+        return a.dist2 < b.dist2;
+    });
+    world->pending_chunk_update_count = static_cast<int>(candidates.size());
+
+    rebuilt_last_run = 0;
+    for (const Candidate& cand : candidates) {
+        if (rebuilt_last_run > 0 && over_budget()) break;
+        cand.chunk->rebuild_subchunk(cand.index);
+        rebuilt_last_run++;
+    }
+
+    uploaded_last_run = 0;
+    auto& uploads = world->chunk_building_queue;
+    while (!uploads.empty()) {
+        if (uploaded_last_run > 0 && over_budget()) break;
+        Chunk* c = uploads.front();
+        uploads.pop_front();
+        c->update_mesh();
+        uploaded_last_run++;
+    }
+}
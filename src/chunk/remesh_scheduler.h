@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class World;
+class Chunk;
+
+// Picks dirty subchunks across all chunks in priority order and rebuilds them
+// against a per-frame time budget, then uploads as many finished chunks as the
+// remaining budget allows. Priority: recently edited chunks first, then chunks
+// inside the view frustum, then everything else; nearest first within a tier.
+class RemeshScheduler {
+public:
+    // Chunks edited within this many ticks count as "recently edited".
+    static constexpr long EDIT_RECENCY_TICKS = 20;
+
+    explicit RemeshScheduler(World* w) : world(w) {}
+
+    // At least one rebuild and one upload always happen when work is pending,
+    // even with a zero budget.
+    void run(int64_t budget_us);
+
+    int rebuilt_last_run = 0;
+    int uploaded_last_run = 0;
+
+private:
+    struct Candidate {
+        int tier;
+        float dist2;
+        Chunk* chunk;
+        int index;
+    };
+
+    World* world;
+    std::vector<Candidate> candidates;
+};
@@ -4,25 +4,14 @@
 #include "../options.h"
 #include <algorithm>
 #include <array>
-#include <cmath>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace {
-inline int16_t pack_pos_component(float v) {
-    int val = static_cast<int>(std::round(v * 16.0f));
-    val = std::clamp(val, -32768, 32767);
-    return static_cast<int16_t>(val);
-}
-
-inline uint8_t pack_uv(float v) {
-    int val = static_cast<int>(std::round(v * 255.0f));
-    return static_cast<uint8_t>(std::clamp(val, 0, 255));
-}
-
-inline uint8_t pack_shading(float v) {
-    int val = static_cast<int>(std::round(v * 255.0f));
-    return static_cast<uint8_t>(std::clamp(val, 0, 255));
-}
-
 inline uint32_t pack_pos_xy(int16_t x, int16_t y) {
     return static_cast<uint16_t>(x) | (static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16);
 }
@@ -37,168 +26,215 @@ inline uint32_t pack_attr(uint8_t layer, uint8_t shading, uint8_t blocklight, ui
            (static_cast<uint32_t>(blocklight & 0xF) << 16) |
            (static_cast<uint32_t>(skylight & 0xF) << 20);
 }
-} // namespace
 
-Subchunk::Subchunk(Chunk* p, glm::ivec3 pos) : parent(p), world(p->world), subchunk_position(pos) {
-    local_position = pos * glm::ivec3(SUBCHUNK_WIDTH, SUBCHUNK_HEIGHT, SUBCHUNK_LENGTH);
-    position = p->position + glm::vec3(local_position);
+inline uint32_t pack_caster_corner(int x, int y, int z) {
+    return static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 5) | (static_cast<uint32_t>(z) << 13);
 }
 
-float Subchunk::smooth(float a, float b, float c, float d) {
-    if (a == 0 || b == 0 || c == 0 || d == 0) {
-        float min_val = a;
-        if (a > 0) {
-            if (b > 0) min_val = std::min(min_val, b);
-            if (c > 0) min_val = std::min(min_val, c);
-            if (d > 0) min_val = std::min(min_val, d);
-        } else {
-            min_val = 0.0f;
+// Unit-cube corner (0 or 1 per axis) of each vertex of each face, in Models::Cube
+// vertex order so merged caster quads keep the cube's winding.
+constexpr uint8_t CUBE_CORNERS[6][4][3] = {
+    {{1, 1, 1}, {1, 0, 1}, {1, 0, 0}, {1, 1, 0}},
+    {{0, 1, 0}, {0, 0, 0}, {0, 0, 1}, {0, 1, 1}},
+    {{1, 1, 1}, {1, 1, 0}, {0, 1, 0}, {0, 1, 1}},
+    {{0, 0, 1}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}},
+    {{0, 1, 1}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}},
+    {{1, 1, 0}, {1, 0, 0}, {0, 0, 0}, {0, 1, 0}},
+};
+// Per face: (slice, row, bit) axes of the caster masks; 0 = x, 1 = y, 2 = z.
+constexpr int CASTER_AXES[6][3] = {{0, 1, 2}, {0, 1, 2}, {1, 2, 0}, {1, 2, 0}, {2, 1, 0}, {2, 1, 0}};
+
+// Neighbours of a face's neighbour voxel, laid out as
+//   0 1 2
+//   3 . 4
+//   5 6 7
+// in the face plane. Bit i of FaceSamples::opaque_mask is neighbour i.
+using namespace Util;
+const glm::ivec3 NEIGHBOUR_OFFSETS[6][8] = {
+    {UP+SOUTH, UP, UP+NORTH, SOUTH, NORTH, DOWN+SOUTH, DOWN, DOWN+NORTH},
+    {UP+NORTH, UP, UP+SOUTH, NORTH, SOUTH, DOWN+NORTH, DOWN, DOWN+SOUTH},
+    {SOUTH+EAST, SOUTH, SOUTH+WEST, EAST, WEST, NORTH+EAST, NORTH, NORTH+WEST},
+    {SOUTH+WEST, SOUTH, SOUTH+EAST, WEST, EAST, NORTH+WEST, NORTH, NORTH+EAST},
+    {UP+WEST, UP, UP+EAST, WEST, EAST, DOWN+WEST, DOWN, DOWN+EAST},
+    {UP+EAST, UP, UP+WEST, EAST, WEST, DOWN+EAST, DOWN, DOWN+WEST},
+};
+
+// Per vertex: (side, side, diagonal) neighbour indices.
+constexpr int CORNER_SAMPLES[4][3] = {{1, 3, 0}, {3, 6, 5}, {4, 6, 7}, {1, 4, 2}};
+
+// Classic vertex AO: both sides blocked -> 0.25, otherwise 1 - blocked/4,
+// already converted to shading bytes.
+constexpr std::array<std::array<uint8_t, 4>, 256> make_ao_lut() {
+    constexpr uint8_t levels[4] = {255, 191, 128, 64};
+    std::array<std::array<uint8_t, 4>, 256> lut{};
+    for (int mask = 0; mask < 256; mask++) {
+        for (int c = 0; c < 4; c++) {
+            int s1 = (mask >> CORNER_SAMPLES[c][0]) & 1;
+            int s2 = (mask >> CORNER_SAMPLES[c][1]) & 1;
+            int d = (mask >> CORNER_SAMPLES[c][2]) & 1;
+            lut[mask][c] = (s1 && s2) ? levels[3] : levels[s1 + s2 + d];
         }
-
-        a = std::max(a, min_val);
-        b = std::max(b, min_val);
-        c = std::max(c, min_val);
-        d = std::max(d, min_val);
     }
-    return (a + b + c + d) / 4.0f;
+    return lut;
 }
-
-float Subchunk::ao_val(bool s1, bool s2, bool c) {
-    if (s1 && s2) return 0.25f;
-    return 1.0f - (s1 + s2 + c) / 4.0f;
-}
-
-std::array<float, 4> Subchunk::get_face_ao(bool s1, bool s2, bool s3, bool s4, bool s5, bool s6, bool s7, bool s8) {
-    return {ao_val(s2, s4, s1), ao_val(s4, s7, s6), ao_val(s5, s7, s8), ao_val(s2, s5, s3)};
-}
-
-std::array<float, 4> Subchunk::get_smooth_face_light(float light, float l1, float l2, float l3, float l4, float l5, float l6, float l7, float l8) {
-    return {smooth(light, l2, l4, l1), smooth(light, l4, l7, l6), smooth(light, l5, l7, l8), smooth(light, l2, l5, l3)};
-}
-
-std::array<glm::ivec3, 8> Subchunk::get_neighbour_voxels(glm::ivec3 npos, int face) {
-    using namespace Util;
-    std::array<glm::ivec3, 8> n{};
-    if(face==0) n={npos+UP+SOUTH, npos+UP, npos+UP+NORTH, npos+SOUTH, npos+NORTH, npos+DOWN+SOUTH, npos+DOWN, npos+DOWN+NORTH};
-    else if(face==1) n={npos+UP+NORTH, npos+UP, npos+UP+SOUTH, npos+NORTH, npos+SOUTH, npos+DOWN+NORTH, npos+DOWN, npos+DOWN+SOUTH};
-    else if(face==2) n={npos+SOUTH+EAST, npos+SOUTH, npos+SOUTH+WEST, npos+EAST, npos+WEST, npos+NORTH+EAST, npos+NORTH, npos+NORTH+WEST};
-    else if(face==3) n={npos+SOUTH+WEST, npos+SOUTH, npos+SOUTH+EAST, npos+WEST, npos+EAST, npos+NORTH+WEST, npos+NORTH, npos+NORTH+EAST};
-    else if(face==4) n={npos+UP+WEST, npos+UP, npos+UP+EAST, npos+WEST, npos+EAST, npos+DOWN+WEST, npos+DOWN, npos+DOWN+EAST};
-    else if(face==5) n={npos+UP+EAST, npos+UP, npos+UP+WEST, npos+EAST, npos+WEST, npos+DOWN+EAST, npos+DOWN, npos+DOWN+WEST};
-    return n;
-}
-
-std::array<float, 4> Subchunk::get_light(int block, int face, glm::ivec3 pos, glm::ivec3 npos) {
-    BlockType& bt = *world->block_types[block];
-    if (!bt.is_cube) {
-        float v = static_cast<float>(parent->get_light_cached(pos));
-        return {v, v, v, v};
+constexpr auto AO_LUT = make_ao_lut();
+
+// Smooth light for the four vertices: average of the centre and the three
+// corner neighbours, where unlit neighbours borrow the dimmest lit value (so
+// walls don't leak darkness), unless the centre itself is dark.
+// Block light and skylight are processed together as eight 16-bit lanes.
+void smooth_corners(const Subchunk::FaceSamples& s, std::array<uint8_t, 4>& light, std::array<uint8_t, 4>& sky) {
+#ifdef __SSE2__
+    const uint8_t* L = s.light;
+    const uint8_t* S = s.sky;
+    const int (&k)[4][3] = CORNER_SAMPLES;
+    __m128i a = _mm_setr_epi16(L[8], L[8], L[8], L[8], S[8], S[8], S[8], S[8]);
+    __m128i b = _mm_setr_epi16(L[k[0][0]], L[k[1][0]], L[k[2][0]], L[k[3][0]], S[k[0][0]], S[k[1][0]], S[k[2][0]], S[k[3][0]]);
+    __m128i c = _mm_setr_epi16(L[k[0][1]], L[k[1][1]], L[k[2][1]], L[k[3][1]], S[k[0][1]], S[k[1][1]], S[k[2][1]], S[k[3][1]]);
+    __m128i d = _mm_setr_epi16(L[k[0][2]], L[k[1][2]], L[k[2][2]], L[k[3][2]], S[k[0][2]], S[k[1][2]], S[k[2][2]], S[k[3][2]]);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i big = _mm_set1_epi16(0xFF);
+    __m128i az = _mm_cmpeq_epi16(a, zero), bz = _mm_cmpeq_epi16(b, zero);
+    __m128i cz = _mm_cmpeq_epi16(c, zero), dz = _mm_cmpeq_epi16(d, zero);
+
+    // Minimum over lit samples; zero when the centre is dark.
+    __m128i m = _mm_min_epi16(_mm_or_si128(a, _mm_and_si128(az, big)), _mm_or_si128(b, _mm_and_si128(bz, big)));
+    m = _mm_min_epi16(m, _mm_or_si128(c, _mm_and_si128(cz, big)));
+    m = _mm_min_epi16(m, _mm_or_si128(d, _mm_and_si128(dz, big)));
+    m = _mm_andnot_si128(az, m);
+
+    __m128i sum = _mm_add_epi16(a, _mm_or_si128(b, _mm_and_si128(bz, m)));
+    sum = _mm_add_epi16(sum, _mm_or_si128(c, _mm_and_si128(cz, m)));
+    sum = _mm_add_epi16(sum, _mm_or_si128(d, _mm_and_si128(dz, m)));
+    sum = _mm_srli_epi16(sum, 2);
+
+    alignas(16) uint16_t out[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(out), sum);
+    for (int i = 0; i < 4; i++) {
+        light[i] = static_cast<uint8_t>(out[i]);
+        sky[i] = static_cast<uint8_t>(out[4 + i]);
     }
-
-    bool complex_model = (bt.vertex_positions.size() != 6);
-    glm::ivec3 target_pos = complex_model ? pos : npos;
-
-    if (!Options::SMOOTH_LIGHTING || complex_model) {
-        float v = static_cast<float>(parent->get_light_cached(target_pos));
-        return {v, v, v, v};
+#else
+    auto corner = [](int a, int b, int c, int d) {
+        int m = 0;
+        if (a > 0) {
+            m = a;
+            if (b > 0) m = std::min(m, b);
+            if (c > 0) m = std::min(m, c);
+            if (d > 0) m = std::min(m, d);
+        }
+        return static_cast<uint8_t>((a + (b ? b : m) + (c ? c : m) + (d ? d : m)) >> 2);
+    };
+    for (int i = 0; i < 4; i++) {
+        const int* k = CORNER_SAMPLES[i];
+        light[i] = corner(s.light[8], s.light[k[0]], s.light[k[1]], s.light[k[2]]);
+        sky[i] = corner(s.sky[8], s.sky[k[0]], s.sky[k[1]], s.sky[k[2]]);
     }
-
-    auto neighbors = get_neighbour_voxels(target_pos, face);
-    float l = parent->get_light_cached(target_pos);
-    return get_smooth_face_light(l, parent->get_light_cached(neighbors[0]), parent->get_light_cached(neighbors[1]), parent->get_light_cached(neighbors[2]),
-                                 parent->get_light_cached(neighbors[3]), parent->get_light_cached(neighbors[4]),
-                                 parent->get_light_cached(neighbors[5]), parent->get_light_cached(neighbors[6]), parent->get_light_cached(neighbors[7]));
+#endif
 }
+} // namespace
 
-std::array<float, 4> Subchunk::get_skylight(int block, int face, glm::ivec3 pos, glm::ivec3 npos) {
-    BlockType& bt = *world->block_types[block];
-    if (!bt.is_cube) {
-        float v = static_cast<float>(parent->get_skylight_cached(pos));
-        return {v, v, v, v};
-    }
-
-    if (!Options::SMOOTH_LIGHTING) {
-        float v = static_cast<float>(parent->get_skylight_cached(npos));
-        return {v, v, v, v};
-    }
-    auto neighbors = get_neighbour_voxels(npos, face);
+void Subchunk::init(Chunk* p, glm::ivec3 pos) {
+    parent = p;
+    world = p->world;
+    subchunk_position = pos;
+    local_position = pos * glm::ivec3(SUBCHUNK_WIDTH, SUBCHUNK_HEIGHT, SUBCHUNK_LENGTH);
+    position = p->position + glm::vec3(local_position);
 
-    float l = parent->get_skylight_cached(npos);
-    return get_smooth_face_light(l, parent->get_skylight_cached(neighbors[0]), parent->get_skylight_cached(neighbors[1]), parent->get_skylight_cached(neighbors[2]),
-                                 parent->get_skylight_cached(neighbors[3]), parent->get_skylight_cached(neighbors[4]),
-                                 parent->get_skylight_cached(neighbors[5]), parent->get_skylight_cached(neighbors[6]), parent->get_skylight_cached(neighbors[7]));
+    // Pooled chunks are re-bound to a new position; forget the previous one's state.
+    input_hash = 0;
+    has_mesh = false;
+    staged = false;
+    border_mask = 0;
+    missing_mask = 0;
+    emitters.clear();
+    cutout_start = 0;
+    caster_mesh.clear();
+    if (mesh.capacity()) world->mesh_pool.release(mesh);
+    if (translucent_mesh.capacity()) world->mesh_pool.release(translucent_mesh);
 }
 
-std::array<float, 4> Subchunk::get_shading(int block, BlockType& bt, int face, glm::ivec3 npos) {
-    (void)block;
-    if (!Options::SMOOTH_LIGHTING) {
-        std::array<float, 4> out{};
-        const auto& src = bt.shading_values[face];
-        for (int i = 0; i < 4 && i < static_cast<int>(src.size()); i++) out[i] = src[i];
-        return out;
+Subchunk::FaceSamples Subchunk::sample_face(int face, glm::ivec3 npos) const {
+    FaceSamples s{};
+    for (int i = 0; i < 8; i++) {
+        uint8_t raw = 0;
+        int id = parent->get_voxel_cached(npos + NEIGHBOUR_OFFSETS[face][i], raw);
+        if (world->block_properties.is_opaque(id)) s.opaque_mask |= static_cast<uint8_t>(1u << i);
+        s.light[i] = raw & 0xF;
+        s.sky[i] = raw >> 4;
     }
-
-    if (bt.vertex_positions.size() != 6) {
-        return {1.0f, 1.0f, 1.0f, 1.0f};
-    }
-
-    auto neighbors = get_neighbour_voxels(npos, face);
-
-    return get_face_ao(parent->is_opaque_cached(neighbors[0]), parent->is_opaque_cached(neighbors[1]), parent->is_opaque_cached(neighbors[2]),
-                       parent->is_opaque_cached(neighbors[3]), parent->is_opaque_cached(neighbors[4]),
-                       parent->is_opaque_cached(neighbors[5]), parent->is_opaque_cached(neighbors[6]), parent->is_opaque_cached(neighbors[7]));
+    uint8_t raw = 0;
+    parent->get_voxel_cached(npos, raw);
+    s.light[8] = raw & 0xF;
+    s.sky[8] = raw >> 4;
+    return s;
 }
 
-void Subchunk::add_face(int face, glm::ivec3 pos, glm::ivec3 lpos, int block, BlockType& bt, glm::ivec3 npos) {
-    auto& target = bt.translucent ? translucent_mesh : mesh;
-    auto shading = get_shading(block, bt, face, npos);
-    auto lights = get_light(block, face, pos, npos);
-    auto skylights = get_skylight(block, face, pos, npos);
-
-    bool has_uv = (face < static_cast<int>(bt.tex_coords.size()));
-
-    for(int i=0; i<4; i++) {
-        float vx = bt.vertex_positions[face][i*3+0] + lpos.x;
-        float vy = bt.vertex_positions[face][i*3+1] + lpos.y;
-        float vz = bt.vertex_positions[face][i*3+2] + lpos.z;
-
-        uint8_t u = 0, v = 0;
-        if (has_uv) {
-            u = pack_uv(bt.tex_coords[face][i*2+0]);
-            v = pack_uv(bt.tex_coords[face][i*2+1]);
+template <bool Smooth, FaceShape Shape>
+void Subchunk::add_face(std::vector<uint32_t>& target, int face, glm::ivec3 pos, glm::ivec3 lpos, const FaceTemplate& tmpl, glm::ivec3 npos, bool six_faces) {
+    std::array<uint8_t, 4> shading = tmpl.shading;
+    std::array<uint8_t, 4> lights{}, skylights{};
+
+    if constexpr (Smooth && Shape == FaceShape::Cube) {
+        FaceSamples s = sample_face(face, npos);
+        shading = AO_LUT[s.opaque_mask];
+        smooth_corners(s, lights, skylights);
+    } else if constexpr (Smooth && Shape == FaceShape::ComplexCube) {
+        // Block light stays flat at the block itself, skylight is smoothed around the neighbour.
+        FaceSamples s = sample_face(face, npos);
+        std::array<uint8_t, 4> unused{};
+        smooth_corners(s, unused, skylights);
+        lights.fill(static_cast<uint8_t>(parent->get_light_cached(pos)));
+        shading = {255, 255, 255, 255};
+    } else {
+        glm::ivec3 light_pos = (Shape == FaceShape::Cube) ? npos : pos;
+        glm::ivec3 sky_pos = (Shape == FaceShape::Model) ? pos : npos;
+        lights.fill(static_cast<uint8_t>(parent->get_light_cached(light_pos)));
+        skylights.fill(static_cast<uint8_t>(parent->get_skylight_cached(sky_pos)));
+        if constexpr (Smooth) {
+            // Six-faced models (leaves, glass, liquid...) still get AO around their own voxel.
+            shading = six_faces ? AO_LUT[sample_face(face, npos).opaque_mask] : std::array<uint8_t, 4>{255, 255, 255, 255};
         }
+    }
 
-        uint8_t layer = static_cast<uint8_t>(bt.tex_indices[face]);
-        uint8_t shade = pack_shading(shading[i]);
-        uint8_t bl = static_cast<uint8_t>(std::clamp<int>(static_cast<int>(lights[i]), 0, 15));
-        uint8_t sl = static_cast<uint8_t>(std::clamp<int>(static_cast<int>(skylights[i]), 0, 15));
+    // Voxel offset in the same 1/16 fixed-point units as the template.
+    int ox = lpos.x * 16, oy = lpos.y * 16, oz = lpos.z * 16;
 
-        int16_t px = pack_pos_component(vx);
-        int16_t py = pack_pos_component(vy);
-        int16_t pz = pack_pos_component(vz);
+    for(int i=0; i<4; i++) {
+        int16_t px = static_cast<int16_t>(tmpl.position[i*3+0] + ox);
+        int16_t py = static_cast<int16_t>(tmpl.position[i*3+1] + oy);
+        int16_t pz = static_cast<int16_t>(tmpl.position[i*3+2] + oz);
 
         target.push_back(pack_pos_xy(px, py));
-        target.push_back(pack_pos_z_uv(pz, u, v));
-        target.push_back(pack_attr(layer, shade, bl, sl));
+        target.push_back(pack_pos_z_uv(pz, tmpl.uv[i*2+0], tmpl.uv[i*2+1]));
+        target.push_back(pack_attr(tmpl.layer, shading[i], lights[i], skylights[i]));
     }
 }
 
-bool Subchunk::can_render_face(BlockType& bt, int block_number, glm::ivec3 position) {
+bool Subchunk::can_render_face(int block_number, glm::ivec3 position) {
     int neighbor_id = parent->get_block_number_cached(position);
 
     if (neighbor_id == 0) return true;
 
-    if (bt.glass && neighbor_id == block_number) return false;
+    const BlockProperties& props = world->block_properties;
+    if (props.is_glass(block_number) && neighbor_id == block_number) return false;
 
-    BlockType* neighbor_type = world->block_types[neighbor_id];
-    if (neighbor_type && neighbor_type->transparent) return true;
-
-    return false;
+    return props.is_transparent(neighbor_id);
 }
 
-void Subchunk::update_mesh() {
-    mesh.clear();
-    translucent_mesh.clear();
+template <bool Smooth, bool Fancy, bool CubeOnly>
+void Subchunk::build_mesh() {
+    const BlockProperties& props = world->block_properties;
+
+    // Faces towards unloaded neighbours are left out and re-emitted when the neighbour streams in.
+    uint8_t unloaded = unloaded_neighbours();
+    border_mask = 0;
+    missing_mask = 0;
+    // Non-solid opaque-pass faces are collected apart and appended after the solid ones.
+    std::vector<uint32_t> cutout;
+    world->mesh_pool.acquire(cutout);
+    CasterMask casters{};
     for (int x=0; x<SUBCHUNK_WIDTH; x++)
         for (int y=0; y<SUBCHUNK_HEIGHT; y++)
             for (int z=0; z<SUBCHUNK_LENGTH; z++) {
@@ -207,19 +243,193 @@ void Subchunk::update_mesh() {
                 int lz = local_position.z + z;
                 int bn = parent->blocks[lx][ly][lz];
                 if (!bn) continue;
-                BlockType& bt = *world->block_types[bn];
+                const BlockType& bt = *world->block_types[bn];
                 glm::ivec3 pos = glm::ivec3(position) + glm::ivec3(x, y, z);
                 glm::ivec3 lpos(lx, ly, lz);
 
-                if (bt.is_cube) {
+                uint8_t edge = (lx == CHUNK_WIDTH - 1 ? 1 << 0 : 0) | (lx == 0 ? 1 << 1 : 0) |
+                               (lz == CHUNK_LENGTH - 1 ? 1 << 4 : 0) | (lz == 0 ? 1 << 5 : 0);
+                border_mask |= edge;
+
+                // Without fancy translucency everything goes through the single opaque pass.
+                bool solid = props.is_opaque(bn) && (CubeOnly || props.is_full_cube(bn));
+                std::vector<uint32_t>& target = (Fancy && props.is_translucent(bn)) ? translucent_mesh : solid ? mesh : cutout;
+
+                auto emit_culled = [&](auto shape_tag) {
+                    constexpr FaceShape Shape = decltype(shape_tag)::value;
                     for(int f=0; f<6; f++) {
+                        if (edge & unloaded & (1 << f)) {
+                            missing_mask |= 1 << f;
+                            continue;
+                        }
                         glm::ivec3 npos = pos + Util::DIRECTIONS[f];
-                        if (can_render_face(bt, bn, npos)) add_face(f, pos, lpos, bn, bt, npos);
+                        if (!can_render_face(bn, npos)) continue;
+                        add_face<Smooth, Shape>(target, f, pos, lpos, bt.faces[f], npos, true);
+                        if (solid) {
+                            const int local[3] = {x, y, z};
+                            const int* axes = CASTER_AXES[f];
+                            casters[f][local[axes[0]]][local[axes[1]]] |= static_cast<uint16_t>(1u << local[axes[2]]);
+                        }
                     }
+                };
+
+                if constexpr (CubeOnly) {
+                    emit_culled(std::integral_constant<FaceShape, FaceShape::Cube>{});
+                } else if (props.is_full_cube(bn)) {
+                    emit_culled(std::integral_constant<FaceShape, FaceShape::Cube>{});
+                } else if (props.is_cube(bn)) {
+                    emit_culled(std::integral_constant<FaceShape, FaceShape::ComplexCube>{});
                 } else {
-                    for(int f=0; f<static_cast<int>(bt.vertex_positions.size()); f++) {
-                        add_face(f, pos, lpos, bn, bt, pos);
+                    bool six_faces = bt.faces.size() == 6;
+                    for(int f=0; f<static_cast<int>(bt.faces.size()); f++) {
+                        add_face<Smooth, FaceShape::Model>(target, f, pos, lpos, bt.faces[f], pos, six_faces);
                     }
                 }
             }
+
+    cutout_start = mesh.size();
+    mesh.insert(mesh.end(), cutout.begin(), cutout.end());
+    world->mesh_pool.release(cutout);
+    build_casters(casters);
+}
+
+void Subchunk::build_casters(CasterMask& faces) {
+    static_assert(SUBCHUNK_WIDTH == SUBCHUNK_HEIGHT && SUBCHUNK_WIDTH == SUBCHUNK_LENGTH, "caster masks assume cubic sections");
+    caster_mesh.clear();
+    const int origin[3] = {local_position.x, local_position.y, local_position.z};
+    for (int f = 0; f < 6; f++) {
+        const int* axes = CASTER_AXES[f];
+        for (int slice = 0; slice < SUBCHUNK_WIDTH; slice++) {
+            uint16_t* rows = faces[f][slice];
+            for (int row = 0; row < SUBCHUNK_WIDTH; row++) {
+                while (rows[row]) {
+                    // Widest run in this row, then grow it over following rows with the same run.
+                    int start = std::countr_zero(static_cast<unsigned>(rows[row]));
+                    int width = std::countr_one(static_cast<unsigned>(rows[row]) >> start);
+                    uint16_t span = static_cast<uint16_t>(((1u << width) - 1) << start);
+                    int end_row = row;
+                    while (end_row + 1 < SUBCHUNK_WIDTH && (rows[end_row + 1] & span) == span) {
+                        rows[++end_row] &= static_cast<uint16_t>(~span);
+                    }
+                    rows[row] &= static_cast<uint16_t>(~span);
+
+                    const int lo[3] = {slice, row, start};
+                    const int hi[3] = {slice + 1, end_row + 1, start + width};
+                    for (int v = 0; v < 4; v++) {
+                        int corner[3];
+                        for (int k = 0; k < 3; k++) {
+                            int axis = axes[k];
+                            bool far = CUBE_CORNERS[f][v][axis];
+                            corner[axis] = origin[axis] + (far ? hi[k] : lo[k]);
+                        }
+                        caster_mesh.push_back(pack_caster_corner(corner[0], corner[1], corner[2]));
+                    }
+                }
+            }
+        }
+    }
+}
+
+Subchunk::MeshKernel Subchunk::select_kernel(bool smooth_lighting, bool fancy_translucency, bool cube_only) {
+    static constexpr MeshKernel kernels[8] = {
+        &Subchunk::build_mesh<false, false, false>, &Subchunk::build_mesh<false, false, true>,
+        &Subchunk::build_mesh<false, true, false>,  &Subchunk::build_mesh<false, true, true>,
+        &Subchunk::build_mesh<true, false, false>,  &Subchunk::build_mesh<true, false, true>,
+        &Subchunk::build_mesh<true, true, false>,   &Subchunk::build_mesh<true, true, true>,
+    };
+    return kernels[(smooth_lighting ? 4 : 0) | (fancy_translucency ? 2 : 0) | (cube_only ? 1 : 0)];
+}
+
+const char* Subchunk::kernel_name(bool smooth_lighting, bool fancy_translucency, bool cube_only) {
+    static const char* names[8] = {
+        "flat", "flat/cube", "flat/fancy", "flat/fancy/cube",
+        "smooth", "smooth/cube", "smooth/fancy", "smooth/fancy/cube",
+    };
+    return names[(smooth_lighting ? 4 : 0) | (fancy_translucency ? 2 : 0) | (cube_only ? 1 : 0)];
+}
+
+bool Subchunk::is_cube_only() const {
+    const BlockProperties& props = world->block_properties;
+    for (int x=0; x<SUBCHUNK_WIDTH; x++)
+        for (int y=0; y<SUBCHUNK_HEIGHT; y++)
+            for (int z=0; z<SUBCHUNK_LENGTH; z++) {
+                int bn = parent->blocks[local_position.x + x][local_position.y + y][local_position.z + z];
+                if (bn && !props.is_full_cube(bn)) return false;
+            }
+    return true;
+}
+
+uint8_t Subchunk::unloaded_neighbours() const {
+    uint8_t mask = 0;
+    for (int d : {0, 1, 4, 5}) {
+        if (!parent->neighbors[d] && !world->chunks.count(parent->chunk_position + Util::DIRECTIONS[d])) mask |= 1 << d;
+    }
+    return mask;
+}
+
+int Subchunk::index() const {
+    return Chunk::subchunk_index(subchunk_position.x, subchunk_position.y, subchunk_position.z);
+}
+
+uint64_t Subchunk::compute_input_hash(bool smooth_lighting, bool fancy_translucency) const {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (smooth_lighting ? 1 : 0) ^ (fancy_translucency ? 2 : 0) ^
+                 (static_cast<uint64_t>(unloaded_neighbours()) << 8);
+    auto mix = [&h](uint64_t v) {
+        h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        h *= 0xFF51AFD7ED558CCDull;
+    };
+    auto mix_voxel = [&](int x, int y, int z) {
+        uint8_t raw = 0;
+        int id = parent->get_voxel_cached(glm::ivec3(position) + glm::ivec3(x, y, z), raw);
+        mix(static_cast<uint64_t>(id) | (static_cast<uint64_t>(raw) << 8));
+    };
+
+    // Interior rows are hashed straight from the chunk arrays, the one-voxel
+    // border goes through the neighbour-aware lookup.
+    for (int x = -1; x <= SUBCHUNK_WIDTH; x++) {
+        for (int y = -1; y <= SUBCHUNK_HEIGHT; y++) {
+            bool inner = x >= 0 && x < SUBCHUNK_WIDTH && y >= 0 && y < SUBCHUNK_HEIGHT;
+            if (!inner) {
+                for (int z = -1; z <= SUBCHUNK_LENGTH; z++) mix_voxel(x, y, z);
+                continue;
+            }
+            mix_voxel(x, y, -1);
+            const uint8_t* blocks = &parent->blocks[local_position.x + x][local_position.y + y][local_position.z];
+            const uint8_t* light = &parent->lightmap[local_position.x + x][local_position.y + y][local_position.z];
+            for (int z = 0; z < SUBCHUNK_LENGTH; z += 8) {
+                uint64_t b, l;
+                std::memcpy(&b, blocks + z, 8);
+                std::memcpy(&l, light + z, 8);
+                mix(b);
+                mix(l);
+            }
+            mix_voxel(x, y, SUBCHUNK_LENGTH);
+        }
+    }
+    return h;
+}
+
+bool Subchunk::update_mesh() {
+    return update_mesh(Options::SMOOTH_LIGHTING, Options::FANCY_TRANSLUCENCY);
+}
+
+bool Subchunk::update_mesh(bool smooth_lighting, bool fancy_translucency) {
+    uint64_t hash = compute_input_hash(smooth_lighting, fancy_translucency);
+    if (has_mesh && hash == input_hash) return false;
+
+    input_hash = hash;
+    has_mesh = true;
+    staged = true;
+    if (world->mesh_cache.take({parent->chunk_position, index(), hash}, mesh, translucent_mesh, caster_mesh, cutout_start,
+                               border_mask, missing_mask)) {
+        return true;
+    }
+
+    if (!mesh.capacity()) world->mesh_pool.acquire(mesh);
+    if (!translucent_mesh.capacity()) world->mesh_pool.acquire(translucent_mesh);
+    mesh.clear();
+    translucent_mesh.clear();
+    MeshKernel kernel = select_kernel(smooth_lighting, fancy_translucency, is_cube_only());
+    (this->*kernel)();
+    return true;
 }
@@ -13,29 +13,86 @@ const int SUBCHUNK_WIDTH = 16;
 const int SUBCHUNK_HEIGHT = 16;
 const int SUBCHUNK_LENGTH = 16;
 
+// How a block's faces are lit and shaded; fixed per block type.
+enum class FaceShape {
+    Cube,        // full six-face cube: culled faces, smooth light and AO
+    ComplexCube, // cube-flagged block with a non-standard face list
+    Model,       // free-form model (plants, torches, slabs, doors...)
+};
+
 class Subchunk {
 public:
-    Chunk* parent;
-    World* world;
-    glm::ivec3 subchunk_position;
-    glm::ivec3 local_position;
-    glm::vec3 position;
+    Chunk* parent = nullptr;
+    World* world = nullptr;
+    glm::ivec3 subchunk_position{0};
+    glm::ivec3 local_position{0};
+    glm::vec3 position{0.0f};
 
+    // Freshly built geometry, held only until Chunk uploads it (staged == true);
+    // the buffers then go back to World::mesh_pool.
     std::vector<uint32_t> mesh;
     std::vector<uint32_t> translucent_mesh;
+    bool staged = false;
+    // `mesh` holds solid cube faces first; from here on (in uint32s) come the faces
+    // the shadow pass has to alpha-test (leaves, plants, glass, models).
+    size_t cutout_start = 0;
+    // Depth-only shadow geometry of the solid cubes: greedy-merged quads, one uint32
+    // per vertex holding a chunk-local cube corner (x | y << 5 | z << 13). Small, so
+    // it stays on the CPU and the chunk re-uploads all of them in one go.
+    std::vector<uint32_t> caster_mesh;
+
+    // Neighbourhood of a face for smooth lighting/AO: eight in-plane neighbours
+    // of the face's neighbour voxel plus the voxel itself at index 8.
+    struct FaceSamples {
+        uint8_t opaque_mask;
+        uint8_t light[9];
+        uint8_t sky[9];
+    };
+
+    // Hash of everything the last mesh was built from (blocks and light of the
+    // section plus a one-voxel border, and the mesher options).
+    uint64_t input_hash = 0;
+    bool has_mesh = false;
+    // Bits indexed like Util::DIRECTIONS (horizontal ones only).
+    // border_mask: the section has blocks on that chunk edge, so its mesh reads the neighbour chunk.
+    // missing_mask: faces on that edge were skipped because the neighbour was not loaded.
+    uint8_t border_mask = 0;
+    uint8_t missing_mask = 0;
+
+    // Light-emitting blocks in the section, packed section-local as x | y << 4 | z << 8.
+    std::vector<uint16_t> emitters;
+    static uint16_t pack_emitter(glm::ivec3 lpos) { return static_cast<uint16_t>(lpos.x | lpos.y << 4 | lpos.z << 8); }
+    static glm::ivec3 unpack_emitter(uint16_t e) { return {e & 0xF, (e >> 4) & 0xF, (e >> 8) & 0xF}; }
 
-    Subchunk(Chunk* p, glm::ivec3 pos);
-    void update_mesh();
+    Subchunk() = default;
+    // Chunks hold their subchunks inline; init binds one to its slot (again when the chunk is reused).
+    void init(Chunk* p, glm::ivec3 pos);
+    // Returns false when the inputs were unchanged and the old mesh was kept.
+    bool update_mesh();
+    // Meshes with an explicit option combination instead of the global Options.
+    bool update_mesh(bool smooth_lighting, bool fancy_translucency);
+    uint64_t compute_input_hash(bool smooth_lighting, bool fancy_translucency) const;
+    // Linear index of the section inside its chunk.
+    int index() const;
+    // Horizontal neighbour chunks that are not loaded, as a Util::DIRECTIONS bitmask.
+    uint8_t unloaded_neighbours() const;
+
+    // True when every non-air block in the section is a full cube.
+    bool is_cube_only() const;
+    static const char* kernel_name(bool smooth_lighting, bool fancy_translucency, bool cube_only);
 
 private:
-    float smooth(float a, float b, float c, float d);
-    float ao_val(bool s1, bool s2, bool c);
-    std::array<float, 4> get_face_ao(bool s1, bool s2, bool s3, bool s4, bool s5, bool s6, bool s7, bool s8);
-    std::array<float, 4> get_smooth_face_light(float light, float l1, float l2, float l3, float l4, float l5, float l6, float l7, float l8);
-    std::array<glm::ivec3, 8> get_neighbour_voxels(glm::ivec3 npos, int face);
-    std::array<float, 4> get_light(int block, int face, glm::ivec3 pos, glm::ivec3 npos);
-    std::array<float, 4> get_skylight(int block, int face, glm::ivec3 pos, glm::ivec3 npos);
-    std::array<float, 4> get_shading(int block, BlockType& bt, int face, glm::ivec3 npos);
-    void add_face(int face, glm::ivec3 pos, glm::ivec3 lpos, int block, BlockType& bt, glm::ivec3 npos);
-    bool can_render_face(BlockType& bt, int block_number, glm::ivec3 position);
+    using MeshKernel = void (Subchunk::*)();
+    static MeshKernel select_kernel(bool smooth_lighting, bool fancy_translucency, bool cube_only);
+
+    template <bool Smooth, bool Fancy, bool CubeOnly> void build_mesh();
+    template <bool Smooth, FaceShape Shape>
+    void add_face(std::vector<uint32_t>& target, int face, glm::ivec3 pos, glm::ivec3 lpos, const FaceTemplate& tmpl, glm::ivec3 npos, bool six_faces);
+
+    // Visible solid faces as [face][slice][row] bitmasks; see build_casters for the axes.
+    using CasterMask = uint16_t[6][SUBCHUNK_WIDTH][SUBCHUNK_WIDTH];
+    void build_casters(CasterMask& faces);
+
+    FaceSamples sample_face(int face, glm::ivec3 npos) const;
+    bool can_render_face(int block_number, glm::ivec3 position);
 };
@@ -0,0 +1,110 @@
+#include "translucent_sorter.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+int decode_signed16(uint32_t v) {
+    return static_cast<int16_t>(v & 0xFFFF);
+}
+}
+
+void collect_translucent_quads(const std::vector<uint32_t>& mesh, std::vector<TranslucentQuad>& out) {
+    // 3 uint32 per vertex, 4 vertices per quad; x/y in word 0, z in the low half of word 1.
+    size_t quads = mesh.size() / 12;
+    out.reserve(out.size() + quads);
+    for (size_t q = 0; q < quads; q++) {
+        const uint32_t* v = mesh.data() + q * 12;
+        int x = 0, y = 0, z = 0;
+        for (int i = 0; i < 4; i++) {
+            x += decode_signed16(v[i * 3]);
+            y += decode_signed16(v[i * 3] >> 16);
+            z += decode_signed16(v[i * 3 + 1]);
+        }
+        out.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), static_cast<uint32_t>(q)});
+    }
+}
+
+void sort_back_to_front(const std::vector<TranslucentQuad>& quads, const glm::vec3& eye, std::vector<uint32_t>& order) {
+    size_t n = quads.size();
+    // Key: inverted distance so that an ascending sort puts the farthest quad first.
+    std::vector<uint16_t> keys(n);
+    glm::vec3 eye64 = eye * 64.0f;
+    for (size_t i = 0; i < n; i++) {
+        glm::vec3 d = glm::vec3(quads[i].x, quads[i].y, quads[i].z) - eye64;
+        float distance = std::sqrt(glm::dot(d, d)) / 4.0f; // 1/16 block steps
+        keys[i] = static_cast<uint16_t>(0xFFFF - std::min(distance, 65535.0f));
+    }
+
+    order.resize(n);
+    std::vector<uint32_t> scratch(n);
+    for (size_t i = 0; i < n; i++) order[i] = static_cast<uint32_t>(i);
+    for (int shift = 0; shift < 16; shift += 8) {
+        std::array<size_t, 257> start{};
+        for (size_t i = 0; i < n; i++) start[((keys[i] >> shift) & 0xFF) + 1]++;
+        for (int b = 0; b < 256; b++) start[b + 1] += start[b];
+        for (uint32_t i : order) scratch[start[(keys[i] >> shift) & 0xFF]++] = i;
+        order.swap(scratch);
+    }
+}
+
+TranslucentSorter::~TranslucentSorter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+uint64_t TranslucentSorter::submit(Job job) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!worker.joinable()) worker = std::thread(&TranslucentSorter::worker_loop, this);
+        id = job.id = next_id++;
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+    return id;
+}
+
+bool TranslucentSorter::poll(Result& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) return false;
+    out = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+void TranslucentSorter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] { return jobs.empty() && !busy; });
+}
+
+void TranslucentSorter::worker_loop() {
+    std::vector<uint32_t> order;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !jobs.empty(); });
+        if (stopping) return;
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        sort_back_to_front(job.quads, job.eye, order);
+        Result result{job.id, job.chunk, job.generation, {}};
+        result.indices.reserve(order.size() * 6);
+        for (uint32_t i : order) {
+            uint32_t q = job.quads[i].quad * 4;
+            result.indices.insert(result.indices.end(), {q, q + 1, q + 2, q + 2, q + 3, q});
+        }
+
+        lock.lock();
+        results.push_back(std::move(result));
+        sorted++;
+        busy = false;
+        if (jobs.empty()) idle.notify_all();
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A translucent quad's centroid in chunk-local 1/64 block units (the sum of its
+// four packed corners) and its index in the chunk's translucent region.
+struct TranslucentQuad {
+    int16_t x, y, z;
+    uint32_t quad;
+};
+
+// Appends one entry per quad of a packed translucent mesh; `quad` counts from 0.
+void collect_translucent_quads(const std::vector<uint32_t>& mesh, std::vector<TranslucentQuad>& out);
+
+// Back-to-front order of `quads` seen from `eye` (chunk-local, in blocks): an LSD
+// radix sort, two 8-bit passes over the distance quantised to 1/16 block.
+void sort_back_to_front(const std::vector<TranslucentQuad>& quads, const glm::vec3& eye, std::vector<uint32_t>& order);
+
+// Sorts translucent quads on a worker thread and hands back ready-to-upload element
+// indices. Jobs carry copies of the centroids, so the worker never touches a Chunk;
+// results name their chunk by position and generation and may be stale on arrival.
+class TranslucentSorter {
+public:
+    struct Job {
+        uint64_t id = 0;
+        glm::ivec3 chunk{0};
+        uint32_t generation = 0; // Chunk::translucent_generation the centroids belong to
+        glm::vec3 eye{0.0f};     // chunk-local
+        std::vector<TranslucentQuad> quads;
+    };
+    struct Result {
+        uint64_t id = 0;
+        glm::ivec3 chunk{0};
+        uint32_t generation = 0;
+        std::vector<uint32_t> indices; // six per quad, relative to the translucent region
+    };
+
+    TranslucentSorter() = default;
+    ~TranslucentSorter();
+    TranslucentSorter(const TranslucentSorter&) = delete;
+    TranslucentSorter& operator=(const TranslucentSorter&) = delete;
+
+    // Queues a job (starting the worker on first use) and returns its id.
+    uint64_t submit(Job job);
+    // Takes one finished result without waiting; false if none is ready.
+    bool poll(Result& out);
+    // Blocks until every submitted job has a result.
+    void flush();
+    size_t jobs_sorted() const { return sorted; }
+
+private:
+    void worker_loop();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    std::deque<Result> results;
+    std::thread worker;
+    bool stopping = false;
+    bool busy = false;
+    uint64_t next_id = 1;
+    std::atomic<size_t> sorted{0};
+};
@@ -0,0 +1,59 @@
+#include "vertex_buffer_pool.h"
+
+VertexBufferPool::Buffer VertexBufferPool::acquire(size_t ints) {
+    size_t best = free_buffers.size();
+    size_t largest = free_buffers.size();
+    for (size_t i = 0; i < free_buffers.size(); i++) {
+        size_t cap = free_buffers[i].capacity;
+        if (cap >= ints && (best == free_buffers.size() || cap < free_buffers[best].capacity)) best = i;
+        if (largest == free_buffers.size() || cap > free_buffers[largest].capacity) largest = i;
+    }
+
+    Buffer buffer;
+    size_t pick = best != free_buffers.size() ? best : largest;
+    if (pick != free_buffers.size()) {
+        buffer = free_buffers[pick];
+        free_buffers[pick] = free_buffers.back();
+        free_buffers.pop_back();
+    } else {
+#ifndef UNIT_TEST
+        glGenBuffers(1, &buffer.id);
+#endif
+        created++;
+    }
+
+    if (buffer.capacity < ints) {
+        size_t capacity = (ints + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+#ifndef UNIT_TEST
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.id);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(uint32_t) * capacity, NULL, GL_DYNAMIC_DRAW);
+#endif
+        buffer.capacity = capacity;
+        reallocated++;
+    }
+    return buffer;
+}
+
+void VertexBufferPool::release(Buffer buffer) {
+    if (!buffer.id && !buffer.capacity) return;
+    if (free_buffers.size() >= MAX_POOLED) {
+#ifndef UNIT_TEST
+        glDeleteBuffers(1, &buffer.id);
+#endif
+        return;
+    }
+    free_buffers.push_back(buffer);
+}
+
+void VertexBufferPool::clear() {
+#ifndef UNIT_TEST
+    for (const Buffer& b : free_buffers) glDeleteBuffers(1, &b.id);
+#endif
+    free_buffers.clear();
+}
+
+size_t VertexBufferPool::bytes() const {
+    size_t total = 0;
+    for (const Buffer& b : free_buffers) total += b.capacity * sizeof(uint32_t);
+    return total;
+}
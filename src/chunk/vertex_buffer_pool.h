@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+// Spare chunk VBOs kept with their allocated size, so relayouts and reused
+// chunks take an existing buffer instead of creating and deleting GL objects.
+class VertexBufferPool {
+public:
+    static constexpr size_t MAX_POOLED = 32;
+    static constexpr size_t GRANULARITY = 4096; // uint32s; sizes round up to this for easier reuse
+
+    struct Buffer {
+        GLuint id = 0;
+        size_t capacity = 0; // in uint32s
+    };
+
+    // Smallest spare holding `ints`; otherwise a spare is grown or a new buffer created.
+    Buffer acquire(size_t ints);
+    void release(Buffer buffer);
+    // Deletes the spares; call while the GL context is still current.
+    void clear();
+
+    size_t size() const { return free_buffers.size(); }
+    size_t bytes() const;
+
+    uint64_t created = 0;    // glGenBuffers calls
+    uint64_t reallocated = 0; // glBufferData calls to grow a buffer
+
+private:
+    std::vector<Buffer> free_buffers;
+};
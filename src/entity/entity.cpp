@@ -92,8 +92,7 @@ void Entity::update(float dt) {
             for(int by = y - step_y * (steps_y + 2); by != cy + step_y * (steps_y + 3); by += step_y) {
                 for(int bz = z - step_z * (steps_xz + 1); bz != cz + step_z * (steps_xz + 2); bz += step_z) {
                     int num = world->get_block_number({bx, by, bz});
-                    if(!num) continue;
-                    if(world->block_types[num] == nullptr) continue;
+                    if(world->block_properties.collider_class(num) == ColliderClass::None) continue;
 
                     for(auto& col_offset : world->block_types[num]->colliders) {
                         // col_offset - это локальный коллайдер блока (0..1), добавляем позицию блока
@@ -93,12 +93,7 @@ void Player::update_matrices(float partial_ticks) {
     mv_matrix = glm::translate(mv_matrix, -interpolated_position - glm::vec3(0, eyelevel + step_offset, 0));
 
     vp_matrix = p_matrix * mv_matrix;
-    if (shader && shader->valid()) {
-        int mvpLoc = shader->find_uniform("u_MVPMatrix");
-        int viewLoc = shader->find_uniform("u_ViewMatrix");
-        shader->setMat4(mvpLoc, vp_matrix);
-        if (viewLoc >= 0) shader->setMat4(viewLoc, mv_matrix);
-    }
+    // The matrices reach the shaders through World::upload_frame_uniforms().
 }
 
 bool Player::check_in_frustum(glm::ivec3 chunk_pos) {
@@ -20,6 +20,7 @@
 #include "text_renderer.h"
 #include "audio.h"
 #include "renderer/post_processor.h"
+#include "renderer/gl_state.h"
 
 // --- КОНСТАНТЫ ---
 const std::string GAME_TITLE = "MC-CPP";
@@ -105,7 +106,7 @@ void update_crosshair_mesh(int w, int h) {
         -tX, -tY,  tX, -lY,   tX, -tY
     };
 
-    glBindVertexArray(crosshairVAO);
+    GLState::bind_vertex_array(crosshairVAO);
     glBindBuffer(GL_ARRAY_BUFFER, crosshairVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
@@ -113,14 +114,14 @@ void update_crosshair_mesh(int w, int h) {
 }
 
 void draw_crosshair() {
-    glUseProgram(uiShaderProgram);
-    glBindVertexArray(crosshairVAO);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
+    GLState::use_program(uiShaderProgram);
+    GLState::bind_vertex_array(crosshairVAO);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::enable(GL_BLEND);
     glBlendFunc(GL_ONE_MINUS_DST_COLOR, GL_ZERO); // Инверсия
     glDrawArrays(GL_TRIANGLES, 0, 18);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_DEPTH_TEST);
+    GLState::enable(GL_DEPTH_TEST);
 }
 
 // --- HEALTH BAR (TRIANGLES) ---
@@ -146,7 +147,7 @@ void init_ui_resources() {
 
     glGenVertexArrays(1, &triangleVAO);
     glGenBuffers(1, &triangleVBO);
-    glBindVertexArray(triangleVAO);
+    GLState::bind_vertex_array(triangleVAO);
     glBindBuffer(GL_ARRAY_BUFFER, triangleVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
 
@@ -154,15 +155,15 @@ void init_ui_resources() {
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glBindVertexArray(0);
+    GLState::bind_vertex_array(0);
 }
 
 void draw_health_bar() {
     if (!uiTriangleShader || !uiTriangleShader->valid() || !player_ptr || triangleVAO == 0) return;
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     uiTriangleShader->use();
@@ -172,7 +173,7 @@ void draw_health_bar() {
     int scaleLoc = uiTriangleShader->find_uniform("u_Scale");
     int fullnessLoc = uiTriangleShader->find_uniform("u_Fullness");
 
-    glBindVertexArray(triangleVAO);
+    GLState::bind_vertex_array(triangleVAO);
 
     float startX = -0.95f;
     float startY = -0.90f;
@@ -195,17 +196,17 @@ void draw_health_bar() {
         glDrawArrays(GL_TRIANGLES, 0, 6);
     }
 
-    glBindVertexArray(0);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
+    GLState::bind_vertex_array(0);
+    GLState::enable(GL_CULL_FACE);
+    GLState::enable(GL_DEPTH_TEST);
 }
 
 // --- F3 DEBUG INFO ---
 void draw_f3_screen(float fps) {
     if (!show_f3 || !text_renderer) return;
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_CULL_FACE);
 
     glm::ivec3 cpos = world_ptr->get_chunk_pos(player_ptr->position);
     glm::ivec3 lpos = world_ptr->get_local_pos(player_ptr->position);
@@ -227,6 +228,39 @@ void draw_f3_screen(float fps) {
     ss << "E: 0/0. B: 0. I: 0";
     lines.push_back(ss.str()); ss.str("");
 
+    ss << "Mesh: " << world_ptr->chunk_update_counter << " built, " << world_ptr->mesh_rebuilds_skipped
+       << " unchanged, " << world_ptr->pending_chunk_update_count << " pending, "
+       << world_ptr->remesh_scheduler.uploaded_last_run << " uploads. Cache: " << world_ptr->mesh_cache.size() << " (" << world_ptr->mesh_cache.hits << " hits)";
+    lines.push_back(ss.str()); ss.str("");
+
+    ss << "Resident: " << world_ptr->chunks.size() << " loaded, "
+       << world_ptr->compressed_chunks.size() << " packed (" << world_ptr->compressed_chunks.bytes_used() / 1024 << " KB)";
+    lines.push_back(ss.str()); ss.str("");
+
+    World::MeshMemory mem = world_ptr->mesh_memory();
+    ss << "Mesh memory: CPU " << mem.cpu_bytes / 1024 << " KB (pool " << mem.pool_bytes / 1024 << " KB), GPU "
+       << mem.gpu_bytes / 1024 << " KB, casters " << mem.caster_bytes / 1024 << " KB, " << world_ptr->mesh_relayouts << " relayouts";
+    lines.push_back(ss.str()); ss.str("");
+
+    if (post_processor && post_processor->valid) {
+        ss << "Render: " << post_processor->renderWidth << "x" << post_processor->renderHeight << " ("
+           << std::lround(post_processor->renderScale() * 100.0f) << "%), GPU " << std::fixed << std::setprecision(1)
+           << post_processor->gpuFrameMs << " ms" << (Options::DEPTH_PREPASS ? ", depth pre-pass" : "");
+        lines.push_back(ss.str()); ss.str("");
+        ss << std::defaultfloat;
+    }
+
+    const GLState::Stats& gl_stats = GLState::stats();
+    ss << "GL state: " << gl_stats.skipped << " of " << gl_stats.calls << " changes redundant";
+    lines.push_back(ss.str()); ss.str("");
+
+    if (world_ptr->shadows_enabled) {
+        ss << "Shadow casters:";
+        for (int n : world_ptr->shadow_caster_counts) ss << " " << n;
+        ss << ", " << world_ptr->shadow_cascades_rendered << " cascades re-rendered";
+        lines.push_back(ss.str()); ss.str("");
+    }
+
     lines.push_back("");
 
     ss << std::fixed << std::setprecision(3)
@@ -268,8 +302,8 @@ void draw_f3_screen(float fps) {
         y += lineHeight;
     }
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_CULL_FACE);
 }
 
 // --- HELPERS & PARSERS ---
@@ -461,7 +495,7 @@ int main() {
     glfwMakeContextCurrent(window);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 
-    glEnable(GL_BLEND);
+    GLState::enable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -469,8 +503,8 @@ int main() {
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetKeyCallback(window, key_callback);
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_CULL_FACE);
 
     init_crosshair();
     update_crosshair_mesh(SCR_WIDTH, SCR_HEIGHT);
@@ -501,8 +535,8 @@ int main() {
         glClearColor(0.06f, 0.08f, 0.10f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_CULL_FACE);
 
         int percent = static_cast<int>(menu_volume * 100.0f + 0.5f);
         const int barSegments = 20;
@@ -515,8 +549,8 @@ int main() {
         text_renderer->RenderText("A/D or Left/Right - adjust", 40.0f, 220.0f, 0.9f, glm::vec3(0.75f));
         text_renderer->RenderText("Enter/Space - start, Esc - quit", 40.0f, 250.0f, 0.9f, glm::vec3(0.75f));
 
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
+        GLState::enable(GL_CULL_FACE);
+        GLState::enable(GL_DEPTH_TEST);
 
         glfwSwapBuffers(window);
     }
@@ -549,10 +583,12 @@ int main() {
     world.player = &player;
     world_ptr = &world;
     player_ptr = &player;
+    post_processor->depthRange = glm::vec2(player.near_plane, player.far_plane);
 
     shader.use();
 
     load_blocks(world, tm);
+    world.build_block_properties();
     tm.generate_mipmaps();
 
     world.save_system = new Save(&world);
@@ -596,11 +632,10 @@ int main() {
         world.tick(static_cast<float>(dt));
 
         // Обновляем матрицы камеры и список видимых чанков до рендера теней
-        // ВАЖНО: делаем use() основного шейдера до update_matrices,
-        // чтобы u_MVPMatrix/u_ViewMatrix записывались в правильную программу.
-        shader.use();
+        // (в шейдеры они попадают через UBO в World::draw).
         player.update_matrices(1.0f);
         world.prepare_rendering();
+        post_processor->beginFrame();
         world.render_shadows();
 
         float daylight_factor = world.get_daylight_factor();
@@ -626,6 +661,7 @@ int main() {
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+        GLState::reset_stats();
         frames++;
 
         if (glfwGetTime() - fps_timer > 1.0) {
@@ -649,7 +685,7 @@ int main() {
     world.save_system->save();
     if (uiTriangleShader) { delete uiTriangleShader; uiTriangleShader = nullptr; }
     if (triangleVBO) glDeleteBuffers(1, &triangleVBO);
-    if (triangleVAO) glDeleteVertexArrays(1, &triangleVAO);
+    if (triangleVAO) GLState::delete_vertex_arrays(1, &triangleVAO);
     Audio::Close();
     delete post_processor;
     glfwTerminate();
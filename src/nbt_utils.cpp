@@ -20,7 +20,10 @@ int32_t read_int_be(const uint8_t* data, size_t& offset) {
     return (int32_t)val;
 }
 
-bool NBT::read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, size_t expected_size) {
+bool NBT::read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, size_t expected_size,
+                                std::vector<int32_t>* emitters, bool* has_emitters) {
+    if (has_emitters) *has_emitters = false;
+
     gzFile file = gzopen(path.c_str(), "rb");
     if (!file) return false;
 
@@ -32,6 +35,7 @@ bool NBT::read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, s
     if (bytes_read <= 0) return false;
 
     size_t cursor = 0;
+    bool blocks_found = false;
 
     auto safe_check = [&](size_t needed) {
         return (cursor + needed <= (size_t)bytes_read);
@@ -97,10 +101,27 @@ bool NBT::read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, s
                 }
                 // === FIX ENDS HERE ===
 
-                return true;
+                cursor += array_len;
+                if (!emitters) return true;
+                blocks_found = true;
+                continue; // "Emitters" follows "Blocks"
             }
             return false;
         }
+        // Light emitter index (IntArray = 11)
+        else if (tagType == 11 && tagName == "Emitters") {
+            if (!safe_check(4)) break;
+            int32_t count = read_int_be(buffer.data(), cursor);
+            if (count < 0 || !safe_check((size_t)count * 4)) break;
+            if (emitters) {
+                emitters->clear();
+                emitters->reserve(count);
+                for (int32_t i = 0; i < count; i++) emitters->push_back(read_int_be(buffer.data(), cursor));
+                if (has_emitters) *has_emitters = true;
+            } else {
+                cursor += (size_t)count * 4;
+            }
+        }
         // Handle "Level" compound to recurse slightly without full parser
         else if (tagType == 10 && tagName == "Level") {
             continue;
@@ -114,6 +135,8 @@ bool NBT::read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, s
         }
     }
 
+    if (blocks_found) return true;
+
     // Fallback: Brute-force search for "Blocks" signature
     const uint8_t header[] = {0x07, 0x00, 0x06, 'B', 'l', 'o', 'c', 'k', 's'};
     for (size_t i = 0; i < (size_t)bytes_read - sizeof(header) - 4; ++i) {
@@ -163,7 +186,8 @@ void write_string(std::vector<uint8_t>& buf, const std::string& str) {
     for(char c : str) buf.push_back(c);
 }
 
-bool NBT::write_blocks_to_gzip(const std::string& path, const uint8_t* src_buffer, int width, int height, int length) {
+bool NBT::write_blocks_to_gzip(const std::string& path, const uint8_t* src_buffer, int width, int height, int length,
+                               const std::vector<int32_t>* emitters) {
     std::vector<uint8_t> nbt;
 
     // 1. Root Compound (Tag 10) - Name ""
@@ -198,7 +222,15 @@ bool NBT::write_blocks_to_gzip(const std::string& path, const uint8_t* src_buffe
         }
     }
 
-    // 4. End Tags
+    // 4. "Emitters" IntArray (Tag 11): indices into Blocks of light-emitting blocks
+    if (emitters) {
+        nbt.push_back(0x0B);
+        write_string(nbt, "Emitters");
+        write_int_be(nbt, (int32_t)emitters->size());
+        for (int32_t index : *emitters) write_int_be(nbt, index);
+    }
+
+    // 5. End Tags
     nbt.push_back(0x00); // End "Level"
     nbt.push_back(0x00); // End Root
 
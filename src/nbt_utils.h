@@ -5,9 +5,13 @@
 
 namespace NBT {
     // Чтение NBT (как было)
-    bool read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, size_t expected_size);
+    // emitters (optional): filled from the "Emitters" IntArray; *has_emitters tells
+    // whether the file had one (saves written before the index existed do not).
+    bool read_blocks_from_gzip(const std::string& path, uint8_t* dest_buffer, size_t expected_size,
+                               std::vector<int32_t>* emitters = nullptr, bool* has_emitters = nullptr);
 
     // Запись массива блоков в сжатый NBT файл
-    // Структура: Root -> Level -> Blocks (ByteArray)
-    bool write_blocks_to_gzip(const std::string& path, const uint8_t* src_buffer, int width, int height, int length);
+    // Структура: Root -> Level -> Blocks (ByteArray) [+ Emitters (IntArray, same index order as Blocks)]
+    bool write_blocks_to_gzip(const std::string& path, const uint8_t* src_buffer, int width, int height, int length,
+                              const std::vector<int32_t>* emitters = nullptr);
 }
@@ -6,12 +6,15 @@ namespace Options {
     inline float FOV = 90.0f;
     inline bool INDIRECT_RENDERING = false;
     inline bool ADVANCED_OPENGL = false;
-    inline int CHUNK_UPDATES = 4;
+    inline int REMESH_BUDGET_US = 4000; // per-frame time for subchunk rebuilds and uploads
+    inline int MESH_CACHE_SIZE = 512; // subchunk meshes kept from unloaded chunks, 0 = off
+    inline int CHUNK_CACHE_BUDGET_MB = 32; // compressed blocks+light of unloaded chunks, 0 = off
     inline bool VSYNC = false;
     inline int MAX_CPU_AHEAD_FRAMES = 3;
     inline bool SMOOTH_FPS = false;
     inline bool SMOOTH_LIGHTING = true;
-    inline bool FANCY_TRANSLUCENCY = true;
+    inline bool FANCY_TRANSLUCENCY = true; // false: translucent faces join the opaque mesh (single pass)
+    inline bool DEPTH_PREPASS = false; // lay down opaque depth first, then shade with GL_EQUAL
     inline int MIPMAP_TYPE = GL_NEAREST_MIPMAP_LINEAR;
     inline bool COLORED_LIGHTING = true;
     inline int ANTIALIASING = 0;
@@ -24,5 +27,18 @@ namespace Options {
     inline float SHADOW_LOG_WEIGHT = 0.85f;
     inline float SHADOW_MIN_BIAS = 0.0006f;
     inline float SHADOW_SLOPE_BIAS = 0.0025f;
-    inline int SHADOW_PCF_RADIUS = 1; // 1 -> 3x3 kernel, 2 -> 5x5
+    inline int SHADOW_PCF_RADIUS = 1; // 0 -> one bilinear PCF tap, >0 -> 4 rotated taps spread over the radius in texels
+    inline float SHADOW_CASCADE_MARGIN = 4.0f; // blocks the camera can move before a cascade is re-fitted
+    inline int SHADOW_FAR_CASCADE_INTERVAL = 4; // cascades past the first re-render at most once per N frames
+    inline int SHADOW_SUN_STEP_TICKS = 20; // the shadow sun direction moves in steps of this many ticks
+
+    // Screen-space ambient occlusion
+    inline float SSAO_STRENGTH = 1.0f; // 0 skips the SSAO pass entirely
+    inline int SSAO_QUALITY = 2; // 0 off, 1 -> 4 depth taps, 2 -> 8
+    inline int SSAO_RESOLUTION_DIVISOR = 2; // AO is computed at 1/N of the screen size per axis (1, 2 or 4)
+
+    // Dynamic resolution: the scene is rendered at a scale picked from measured GPU frame time
+    inline bool DYNAMIC_RESOLUTION = true;
+    inline float TARGET_GPU_FRAME_MS = 16.0f;
+    inline float MIN_RENDER_SCALE = 0.5f;
 }
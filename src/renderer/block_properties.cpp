@@ -0,0 +1,44 @@
+#include "block_properties.h"
+#include "block_type.h"
+#include <algorithm>
+
+void BlockProperties::build(const std::vector<BlockType*>& types, const std::unordered_set<int>& light_blocks) {
+    flags.fill(0);
+    light_emission.fill(0);
+    light_opacity.fill(0);
+    collider.fill(ColliderClass::None);
+
+    // Air: see-through, no collision, no light interaction.
+    flags[0] = BLOCK_TRANSPARENT;
+
+    int count = std::min<int>(static_cast<int>(types.size()), MAX_BLOCK_ID);
+    for (int id = 1; id < count; id++) {
+        const BlockType* bt = types[id];
+        if (!bt) continue;
+
+        uint8_t f = 0;
+        if (bt->transparent) f |= BLOCK_TRANSPARENT;
+        else f |= BLOCK_OPAQUE;
+        if (bt->glass) f |= BLOCK_GLASS;
+        if (bt->translucent) f |= BLOCK_TRANSLUCENT;
+        if (bt->is_cube) f |= BLOCK_CUBE;
+        if (bt->is_cube && bt->faces.size() == 6) f |= BLOCK_FULL_CUBE;
+        flags[id] = f;
+
+        if (!bt->transparent) light_opacity[id] = 15;
+        else if (!bt->glass) light_opacity[id] = 1;
+
+        if (bt->colliders.empty()) {
+            collider[id] = ColliderClass::None;
+        } else {
+            const Collider& c = bt->colliders.front();
+            bool unit = bt->colliders.size() == 1 &&
+                        c.x2 - c.x1 == 1.0f && c.y2 - c.y1 == 1.0f && c.z2 - c.z1 == 1.0f;
+            collider[id] = unit ? ColliderClass::Full : ColliderClass::Partial;
+        }
+    }
+
+    for (int id : light_blocks) {
+        if (id > 0 && id < MAX_BLOCK_ID) light_emission[id] = 15;
+    }
+}
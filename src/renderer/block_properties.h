@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
+
+class BlockType;
+
+enum BlockFlag : uint8_t {
+    BLOCK_OPAQUE      = 1 << 0,
+    BLOCK_TRANSPARENT = 1 << 1,
+    BLOCK_GLASS       = 1 << 2,
+    BLOCK_TRANSLUCENT = 1 << 3,
+    BLOCK_CUBE        = 1 << 4,
+    BLOCK_FULL_CUBE   = 1 << 5, // cube with exactly the six standard faces
+};
+
+enum class ColliderClass : uint8_t {
+    None,    // no collision boxes (air, plants, torches...)
+    Full,    // single unit cube
+    Partial, // anything else (slabs, doors, cactus...)
+};
+
+// Flat struct-of-arrays view of the block registry, indexed by block id.
+// Built once after the block types are loaded; lighting, meshing, physics and
+// streaming read it instead of dereferencing World::block_types.
+struct BlockProperties {
+    static constexpr int MAX_BLOCK_ID = 256;
+
+    std::array<uint8_t, MAX_BLOCK_ID> flags{};
+    std::array<uint8_t, MAX_BLOCK_ID> light_emission{};
+    // Extra skylight decay when light travels straight down through the block
+    // (0 for air/glass, 1 for other see-through blocks, 15 for opaque ones).
+    std::array<uint8_t, MAX_BLOCK_ID> light_opacity{};
+    std::array<ColliderClass, MAX_BLOCK_ID> collider{};
+
+    void build(const std::vector<BlockType*>& types, const std::unordered_set<int>& light_blocks);
+
+    bool is_opaque(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_OPAQUE; }
+    bool is_transparent(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_TRANSPARENT; }
+    bool is_glass(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_GLASS; }
+    bool is_translucent(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_TRANSLUCENT; }
+    bool is_cube(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_CUBE; }
+    bool is_full_cube(int id) const { return flags[static_cast<uint8_t>(id)] & BLOCK_FULL_CUBE; }
+    int emission(int id) const { return light_emission[static_cast<uint8_t>(id)]; }
+    int opacity(int id) const { return light_opacity[static_cast<uint8_t>(id)]; }
+    ColliderClass collider_class(int id) const { return collider[static_cast<uint8_t>(id)]; }
+};
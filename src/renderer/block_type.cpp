@@ -1,6 +1,20 @@
 #include "block_type.h"
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int16_t pack_pos_component(float v) {
+    int val = static_cast<int>(std::round(v * 16.0f));
+    return static_cast<int16_t>(std::clamp(val, -32768, 32767));
+}
+
+uint8_t pack_unorm8(float v) {
+    int val = static_cast<int>(std::round(v * 255.0f));
+    return static_cast<uint8_t>(std::clamp(val, 0, 255));
+}
+} // namespace
 
 BlockType::BlockType(TextureManager* tm, std::string name, std::map<std::string, std::string> face_tex, ModelData md)
 : name(name), model(md), block_face_textures(face_tex) {
@@ -12,9 +26,6 @@ BlockType::BlockType(TextureManager* tm, std::string name, std::map<std::string,
 
     for (const auto& c : md.colliders) colliders.push_back(Collider(c.first, c.second));
 
-    vertex_positions = md.vertex_positions;
-    tex_coords = md.tex_coords;
-    shading_values = md.shading_values;
     tex_indices.resize(md.tex_coords_len, 0);
 
     // Helper lambda to set texture index
@@ -51,4 +62,27 @@ BlockType::BlockType(TextureManager* tm, std::string name, std::map<std::string,
     apply_texture("bottom", [&](int idx) { set_face(3, idx); });
     apply_texture("front",  [&](int idx) { set_face(4, idx); });
     apply_texture("back",   [&](int idx) { set_face(5, idx); });
+
+    bake_faces();
+}
+
+void BlockType::bake_faces() {
+    faces.clear();
+    faces.resize(model.vertex_positions.size());
+    for (size_t f = 0; f < faces.size(); f++) {
+        FaceTemplate& face = faces[f];
+        const auto& pos = model.vertex_positions[f];
+        for (size_t i = 0; i < face.position.size() && i < pos.size(); i++) {
+            face.position[i] = pack_pos_component(pos[i]);
+        }
+        if (f < model.tex_coords.size()) {
+            const auto& uv = model.tex_coords[f];
+            for (size_t i = 0; i < face.uv.size() && i < uv.size(); i++) face.uv[i] = pack_unorm8(uv[i]);
+        }
+        if (f < model.shading_values.size()) {
+            const auto& shade = model.shading_values[f];
+            for (size_t i = 0; i < face.shading.size() && i < shade.size(); i++) face.shading[i] = pack_unorm8(shade[i]);
+        }
+        face.layer = (f < tex_indices.size()) ? static_cast<uint8_t>(tex_indices[f]) : 0;
+    }
 }
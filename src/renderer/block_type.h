@@ -2,10 +2,22 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <array>
+#include <cstdint>
 #include "../models/model_data.h"
 #include "texture_manager.h"
 #include "../physics/collider.h"
 
+// One model face baked into the packed vertex layout used by Subchunk.
+// Positions are in 1/16 block units relative to the block centre, so the
+// mesher only has to add the voxel offset and fill in light/AO.
+struct FaceTemplate {
+    std::array<int16_t, 12> position{}; // x,y,z for 4 vertices
+    std::array<uint8_t, 8> uv{};        // u,v for 4 vertices (0..255)
+    std::array<uint8_t, 4> shading{};   // flat per-vertex shading (0..255)
+    uint8_t layer = 0;                  // texture array layer
+};
+
 class BlockType {
 public:
     std::string name;
@@ -18,11 +30,12 @@ public:
     bool translucent;
 
     std::vector<Collider> colliders;
-    std::vector<std::vector<float>> vertex_positions;
-    std::vector<std::vector<float>> tex_coords; // <-- ДОБАВЛЕНО
     std::vector<int> tex_indices;
-    std::vector<std::vector<float>> shading_values;
+    std::vector<FaceTemplate> faces;
 
     BlockType() {}
     BlockType(TextureManager* tm, std::string name, std::map<std::string, std::string> face_tex, ModelData md);
+
+    // Re-packs model geometry, UVs, shading and texture layers into faces.
+    void bake_faces();
 };
@@ -0,0 +1,41 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+float snap_scale(float scale, float min_scale) {
+    scale = std::round(scale / DynamicResolution::STEP) * DynamicResolution::STEP;
+    return std::clamp(scale, std::min(min_scale, DynamicResolution::MAX_SCALE), DynamicResolution::MAX_SCALE);
+}
+}
+
+bool DynamicResolution::update(float gpu_ms, float target_ms, float min_scale) {
+    if (gpu_ms <= 0.0f || target_ms <= 0.0f) return false;
+    average_ms = average_ms > 0.0f ? average_ms + (gpu_ms - average_ms) * SMOOTHING : gpu_ms;
+
+    frames_over = average_ms > target_ms * (1.0f + DOWN_THRESHOLD) ? frames_over + 1 : 0;
+    frames_under = average_ms < target_ms * (1.0f - UP_THRESHOLD) ? frames_under + 1 : 0;
+
+    float next = current_scale;
+    if (frames_over >= DOWN_FRAMES) {
+        // Cost is roughly proportional to the pixel count, i.e. scale^2
+        float estimate = current_scale * std::sqrt(target_ms / average_ms);
+        next = std::min(snap_scale(estimate, min_scale), current_scale - STEP);
+    } else if (frames_under >= UP_FRAMES) {
+        next = current_scale + STEP;
+    }
+    next = snap_scale(next, min_scale);
+    if (next == current_scale) return false;
+
+    current_scale = next;
+    frames_over = frames_under = 0;
+    // The old average describes the old resolution
+    average_ms = 0.0f;
+    return true;
+}
+
+void DynamicResolution::reset() {
+    current_scale = MAX_SCALE;
+    average_ms = 0.0f;
+    frames_over = frames_under = 0;
+}
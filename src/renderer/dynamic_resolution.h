@@ -0,0 +1,32 @@
+#pragma once
+
+// Picks the scene render scale from measured GPU frame times. Frame times are
+// smoothed, and the scale only moves after the budget has been missed (or
+// comfortably met) for a run of frames, so it does not oscillate around the
+// target. Scales are multiples of STEP so the scene targets are not
+// reallocated for tiny changes.
+class DynamicResolution {
+public:
+    static constexpr float STEP = 0.05f;
+    static constexpr float MAX_SCALE = 1.0f;
+    // Over budget by more than this fraction for DOWN_FRAMES frames -> lower the scale.
+    static constexpr float DOWN_THRESHOLD = 0.05f;
+    static constexpr int DOWN_FRAMES = 8;
+    // Under budget by more than this fraction for UP_FRAMES frames -> raise it one step.
+    static constexpr float UP_THRESHOLD = 0.2f;
+    static constexpr int UP_FRAMES = 60;
+    static constexpr float SMOOTHING = 0.15f;
+
+    // Feeds one GPU frame time; returns true if the scale changed.
+    bool update(float gpu_ms, float target_ms, float min_scale);
+    void reset();
+
+    float scale() const { return current_scale; }
+    float smoothed_ms() const { return average_ms; }
+
+private:
+    float current_scale = MAX_SCALE;
+    float average_ms = 0.0f;
+    int frames_over = 0;
+    int frames_under = 0;
+};
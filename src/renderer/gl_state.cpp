@@ -0,0 +1,108 @@
+#include "gl_state.h"
+
+namespace {
+constexpr GLenum CACHED_CAPS[] = {GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_DEPTH_CLAMP};
+constexpr int CAP_COUNT = sizeof(CACHED_CAPS) / sizeof(CACHED_CAPS[0]);
+enum class Known : uint8_t { Unknown, Off, On };
+
+struct State {
+    bool program_known = false;
+    GLuint program = 0;
+    bool vao_known = false;
+    GLuint vao = 0;
+    Known caps[CAP_COUNT] = {};
+    Known depth_write = Known::Unknown;
+    GLenum depth_func = 0; // 0 = unknown
+};
+
+State state;
+GLState::Stats counters;
+
+int cap_index(GLenum cap) {
+    for (int i = 0; i < CAP_COUNT; i++) {
+        if (CACHED_CAPS[i] == cap) return i;
+    }
+    return -1;
+}
+
+// Counts the request; true if it is already in effect.
+bool skip(bool same) {
+    counters.calls++;
+    if (same) counters.skipped++;
+    return same;
+}
+}
+
+namespace GLState {
+void use_program(GLuint program) {
+    if (skip(state.program_known && state.program == program)) return;
+    state.program_known = true;
+    state.program = program;
+#ifndef UNIT_TEST
+    glUseProgram(program);
+#endif
+}
+
+void bind_vertex_array(GLuint vao) {
+    if (skip(state.vao_known && state.vao == vao)) return;
+    state.vao_known = true;
+    state.vao = vao;
+#ifndef UNIT_TEST
+    glBindVertexArray(vao);
+#endif
+}
+
+void set_enabled(GLenum cap, bool enabled) {
+    int i = cap_index(cap);
+    Known want = enabled ? Known::On : Known::Off;
+    if (i >= 0) {
+        if (skip(state.caps[i] == want)) return;
+        state.caps[i] = want;
+    }
+#ifndef UNIT_TEST
+    if (enabled) glEnable(cap);
+    else glDisable(cap);
+#endif
+}
+
+void depth_mask(bool write) {
+    Known want = write ? Known::On : Known::Off;
+    if (skip(state.depth_write == want)) return;
+    state.depth_write = want;
+#ifndef UNIT_TEST
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+#endif
+}
+
+void depth_func(GLenum func) {
+    if (skip(state.depth_func == func)) return;
+    state.depth_func = func;
+#ifndef UNIT_TEST
+    glDepthFunc(func);
+#endif
+}
+
+void delete_vertex_arrays(GLsizei n, const GLuint* arrays) {
+    for (GLsizei i = 0; i < n; i++) {
+        if (state.vao_known && state.vao == arrays[i]) state.vao = 0;
+    }
+#ifndef UNIT_TEST
+    glDeleteVertexArrays(n, arrays);
+#endif
+}
+
+void delete_program(GLuint program) {
+    // A bound program stays in use until another is bound, but its name may be reused.
+    if (state.program_known && state.program == program) state.program_known = false;
+#ifndef UNIT_TEST
+    glDeleteProgram(program);
+#endif
+}
+
+void invalidate() {
+    state = State{};
+}
+
+const Stats& stats() { return counters; }
+void reset_stats() { counters = Stats{}; }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+
+// Shadow of the GL state the renderer changes most often; calls that would not
+// change it are skipped. Code that binds programs or vertex arrays, toggles these
+// capabilities or changes the depth state must go through here, or call
+// invalidate() afterwards, for the cache to stay correct.
+namespace GLState {
+    void use_program(GLuint program);
+    void bind_vertex_array(GLuint vao);
+    // Cached: GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_DEPTH_CLAMP; other capabilities pass through.
+    void set_enabled(GLenum cap, bool enabled);
+    inline void enable(GLenum cap) { set_enabled(cap, true); }
+    inline void disable(GLenum cap) { set_enabled(cap, false); }
+    void depth_mask(bool write);
+    void depth_func(GLenum func);
+
+    // Deleting a bound object resets the binding to 0; names may be reused afterwards.
+    void delete_vertex_arrays(GLsizei n, const GLuint* arrays);
+    void delete_program(GLuint program);
+    // Forgets everything, e.g. after a context change.
+    void invalidate();
+
+    struct Stats {
+        uint64_t calls = 0;   // state changes requested
+        uint64_t skipped = 0; // of those, already in effect
+    };
+    const Stats& stats();
+    void reset_stats();
+}
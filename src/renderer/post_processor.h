@@ -1,8 +1,13 @@
 #pragma once
 #include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <glm/vec2.hpp>
 #include "shader.h"
+#include "gl_state.h"
+#include "dynamic_resolution.h"
+#include "../options.h"
 
 class PostProcessor {
 public:
@@ -11,10 +16,32 @@ public:
     unsigned int depthTexture = 0;
     unsigned int quadVAO = 0, quadVBO = 0;
     Shader* postShader = nullptr;
-    int width = 0, height = 0;
+    int width = 0, height = 0; // window size, the composite target
+    int renderWidth = 0, renderHeight = 0; // scene FBO size, width/height times the render scale
     bool valid = false;
 
-    PostProcessor(int w, int h) : width(w), height(h) {
+    // GPU frame time from GL_TIME_ELAPSED queries, read back a few frames late so
+    // the CPU never waits on them. It drives the scene render scale.
+    static constexpr int TIMER_QUERIES = 3;
+    unsigned int timerQueries[TIMER_QUERIES] = {};
+    bool queryPending[TIMER_QUERIES] = {};
+    int queryIndex = 0;
+    bool timing = false;
+    float gpuFrameMs = 0.0f;
+    DynamicResolution resolution;
+
+    // SSAO runs as its own pass at 1/aoDivisor of the screen. aoTexture[0] holds the result
+    // (r: occlusion, g: linear view depth), aoTexture[1] the intermediate of the separable blur.
+    // depthRange is the camera's near and far plane, used to linearise the depth buffer.
+    unsigned int aoFBO[2] = {0, 0};
+    unsigned int aoTexture[2] = {0, 0};
+    Shader* ssaoShader = nullptr;
+    Shader* ssaoBlurShader = nullptr;
+    int aoWidth = 0, aoHeight = 0, aoDivisor = 0;
+    bool aoValid = false;
+    glm::vec2 depthRange{0.1f, 500.0f};
+
+    PostProcessor(int w, int h) : width(w), height(h), renderWidth(w), renderHeight(h) {
         postShader = new Shader("assets/shaders/post/vert.glsl", "assets/shaders/post/frag.glsl");
         if (postShader && postShader->valid()) {
             initFramebuffer();
@@ -22,36 +49,84 @@ public:
         } else {
             valid = false;
         }
+        ssaoShader = new Shader("assets/shaders/post/vert.glsl", "assets/shaders/ssao/frag.glsl");
+        ssaoBlurShader = new Shader("assets/shaders/post/vert.glsl", "assets/shaders/ssao/blur_frag.glsl");
+        aoValid = valid && ssaoShader->valid() && ssaoBlurShader->valid();
+        if (aoValid) initAOTargets();
+        if (valid) glGenQueries(TIMER_QUERIES, timerQueries);
     }
 
     ~PostProcessor() {
         if (quadVBO) glDeleteBuffers(1, &quadVBO);
-        if (quadVAO) glDeleteVertexArrays(1, &quadVAO);
+        if (quadVAO) GLState::delete_vertex_arrays(1, &quadVAO);
         if (textureColorBuffer) glDeleteTextures(1, &textureColorBuffer);
         if (depthTexture) glDeleteTextures(1, &depthTexture);
         if (FBO) glDeleteFramebuffers(1, &FBO);
+        if (timerQueries[0]) glDeleteQueries(TIMER_QUERIES, timerQueries);
+        glDeleteTextures(2, aoTexture);
+        glDeleteFramebuffers(2, aoFBO);
         delete postShader;
+        delete ssaoShader;
+        delete ssaoBlurShader;
     }
 
     void resize(int w, int h) {
         if (!valid) return;
         width = w; height = h;
-        glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-        glBindTexture(GL_TEXTURE_2D, depthTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        resizeSceneTargets();
+    }
+
+    float renderScale() const { return resolution.scale(); }
+
+    // Starts timing the frame's GPU work (shadows included) and applies the
+    // render scale picked from earlier frames. Call before any rendering.
+    void beginFrame() {
+        if (!valid || !timerQueries[0]) return;
+
+        bool changed = false;
+        if (queryPending[queryIndex]) {
+            GLint available = 0;
+            glGetQueryObjectiv(timerQueries[queryIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return; // GPU is further behind than the ring; skip timing this frame
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(timerQueries[queryIndex], GL_QUERY_RESULT, &elapsed);
+            queryPending[queryIndex] = false;
+            gpuFrameMs = static_cast<float>(elapsed) / 1.0e6f;
+            if (Options::DYNAMIC_RESOLUTION) {
+                changed = resolution.update(gpuFrameMs, Options::TARGET_GPU_FRAME_MS, Options::MIN_RENDER_SCALE);
+            }
+        }
+        if (!Options::DYNAMIC_RESOLUTION && resolution.scale() != DynamicResolution::MAX_SCALE) {
+            resolution.reset();
+            changed = true;
+        }
+        if (changed) resizeSceneTargets();
+
+        glBeginQuery(GL_TIME_ELAPSED, timerQueries[queryIndex]);
+        timing = true;
     }
 
     void beginRender() {
-        if (valid) glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-        else glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, width, height);
+        if (valid) {
+            glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+            glViewport(0, 0, renderWidth, renderHeight);
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, width, height);
+        }
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     void endRenderAndDraw(bool isUnderwater, float time) {
         if (!valid) return; // already rendered to default framebuffer
 
+        GLState::bind_vertex_array(quadVAO);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_CULL_FACE);
+
+        bool ssao = ssaoEnabled();
+        if (ssao) renderSSAO();
+
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glViewport(0, 0, width, height);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -62,29 +137,118 @@ public:
         postShader->setInt(postShader->find_uniform("u_IsUnderwater"), isUnderwater ? 1 : 0);
         postShader->setFloat(postShader->find_uniform("u_Time"), time);
         postShader->setVec2(postShader->find_uniform("u_ScreenSize"), glm::vec2(width, height));
-        postShader->setFloat(postShader->find_uniform("u_SSAOStrength"), 1.0f);
+        postShader->setInt(postShader->find_uniform("aoTexture"), 2);
+        postShader->setInt(postShader->find_uniform("u_SSAOEnabled"), ssao ? 1 : 0);
+        postShader->setVec2(postShader->find_uniform("u_AOSize"), glm::vec2(aoWidth, aoHeight));
+        postShader->setVec2(postShader->find_uniform("u_DepthRange"), depthRange);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, aoTexture[0]);
+        glActiveTexture(GL_TEXTURE0);
 
-        glBindVertexArray(quadVAO);
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
+        GLState::enable(GL_CULL_FACE);
+        GLState::enable(GL_DEPTH_TEST);
+
+        if (timing) {
+            glEndQuery(GL_TIME_ELAPSED);
+            queryPending[queryIndex] = true;
+            queryIndex = (queryIndex + 1) % TIMER_QUERIES;
+            timing = false;
+        }
     }
 
 private:
+    bool ssaoEnabled() const {
+        return aoValid && Options::SSAO_QUALITY > 0 && Options::SSAO_STRENGTH > 0.0f;
+    }
+
+    // Occlusion from a downsampled depth, then a bilateral blur along x and y.
+    // Expects the quad VAO bound and depth testing off.
+    void renderSSAO() {
+        if (std::max(1, Options::SSAO_RESOLUTION_DIVISOR) != aoDivisor) resizeAOTargets();
+        glViewport(0, 0, aoWidth, aoHeight);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, aoFBO[0]);
+        ssaoShader->use();
+        ssaoShader->setInt(ssaoShader->find_uniform("depthTexture"), 0);
+        ssaoShader->setVec2(ssaoShader->find_uniform("u_ScreenSize"), glm::vec2(renderWidth, renderHeight));
+        ssaoShader->setFloat(ssaoShader->find_uniform("u_SSAOStrength"), Options::SSAO_STRENGTH);
+        ssaoShader->setInt(ssaoShader->find_uniform("u_SSAOTaps"), Options::SSAO_QUALITY >= 2 ? 8 : 4);
+        ssaoShader->setVec2(ssaoShader->find_uniform("u_DepthRange"), depthRange);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        ssaoBlurShader->use();
+        ssaoBlurShader->setInt(ssaoBlurShader->find_uniform("aoTexture"), 0);
+        int directionLoc = ssaoBlurShader->find_uniform("u_Direction");
+
+        glBindFramebuffer(GL_FRAMEBUFFER, aoFBO[1]);
+        glBindTexture(GL_TEXTURE_2D, aoTexture[0]);
+        ssaoBlurShader->setVec2(directionLoc, glm::vec2(1.0f / aoWidth, 0.0f));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, aoFBO[0]);
+        glBindTexture(GL_TEXTURE_2D, aoTexture[1]);
+        ssaoBlurShader->setVec2(directionLoc, glm::vec2(0.0f, 1.0f / aoHeight));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+
+    void initAOTargets() {
+        glGenFramebuffers(2, aoFBO);
+        glGenTextures(2, aoTexture);
+        for (int i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, aoTexture[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        resizeAOTargets();
+        for (int i = 0; i < 2; i++) {
+            glBindFramebuffer(GL_FRAMEBUFFER, aoFBO[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, aoTexture[i], 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                std::cout << "ERROR::FRAMEBUFFER:: SSAO framebuffer is not complete!" << std::endl;
+                aoValid = false;
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void resizeAOTargets() {
+        aoDivisor = std::max(1, Options::SSAO_RESOLUTION_DIVISOR);
+        aoWidth = std::max(1, renderWidth / aoDivisor);
+        aoHeight = std::max(1, renderHeight / aoDivisor);
+        for (int i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, aoTexture[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, aoWidth, aoHeight, 0, GL_RG, GL_HALF_FLOAT, NULL);
+        }
+    }
+
+    // The composite samples the scene color bilinearly, which upscales it to the window.
+    void resizeSceneTargets() {
+        renderWidth = std::max(1, static_cast<int>(std::lround(width * resolution.scale())));
+        renderHeight = std::max(1, static_cast<int>(std::lround(height * resolution.scale())));
+        glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, renderWidth, renderHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, renderWidth, renderHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        if (aoValid) resizeAOTargets();
+    }
+
     void initFramebuffer() {
         glGenFramebuffers(1, &FBO);
         glBindFramebuffer(GL_FRAMEBUFFER, FBO);
 
         glGenTextures(1, &textureColorBuffer);
         glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, renderWidth, renderHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -93,7 +257,7 @@ private:
 
         glGenTextures(1, &depthTexture);
         glBindTexture(GL_TEXTURE_2D, depthTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, renderWidth, renderHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -126,7 +290,7 @@ private:
         };
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bind_vertex_array(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
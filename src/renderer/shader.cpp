@@ -1,4 +1,5 @@
 #include "shader.h"
+#include "gl_state.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -42,12 +43,14 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
         vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
         std::stringstream vShaderStream, fShaderStream;
         vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
         vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        if (fragmentPath) {
+            fShaderFile.open(fragmentPath);
+            fShaderStream << fShaderFile.rdbuf();
+            fragmentCode = fShaderStream.str();
+        }
     } catch (std::ifstream::failure& e) {
         std::cout << "ERROR::SHADER::FILE_NOT_READ: " << e.what() << std::endl;
         ID = 0;
@@ -55,34 +58,63 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     }
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
-    unsigned int vertex, fragment;
+    unsigned int vertex, fragment = 0;
 
     vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vShaderCode, NULL);
     glCompileShader(vertex);
     if (!check_compile(vertex, vertexPath)) { ID = 0; glDeleteShader(vertex); return; }
 
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    if (!check_compile(fragment, fragmentPath)) { ID = 0; glDeleteShader(vertex); glDeleteShader(fragment); return; }
+    if (fragmentPath) {
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        if (!check_compile(fragment, fragmentPath)) { ID = 0; glDeleteShader(vertex); glDeleteShader(fragment); return; }
+    }
 
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    if (fragment) glAttachShader(ID, fragment);
     glLinkProgram(ID);
     bool linked = check_link(ID);
     glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    if (fragment) glDeleteShader(fragment);
     if (!linked) {
-        glDeleteProgram(ID);
+        GLState::delete_program(ID);
         ID = 0;
+        return;
     }
+    cache_uniforms();
 }
 
-Shader::~Shader() { if (ID) glDeleteProgram(ID); }
-void Shader::use() { if (ID) glUseProgram(ID); }
-int Shader::find_uniform(const std::string& name) { return glGetUniformLocation(ID, name.c_str()); }
+void Shader::cache_uniforms() {
+    GLint count = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    char name[256];
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), sizeof(name), &length, &size, &type, name);
+        std::string uniform(name, length);
+        int location = glGetUniformLocation(ID, uniform.c_str());
+        if (location < 0) continue; // member of a uniform block
+        uniform_locations[uniform] = location;
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0) {
+            uniform_locations[uniform.substr(0, uniform.size() - 3)] = location;
+        }
+    }
+
+    GLuint frame_block = glGetUniformBlockIndex(ID, "FrameUniforms");
+    if (frame_block != GL_INVALID_INDEX) glUniformBlockBinding(ID, frame_block, FRAME_UNIFORMS_BINDING);
+}
+
+Shader::~Shader() { if (ID) GLState::delete_program(ID); }
+void Shader::use() { if (ID) GLState::use_program(ID); }
+int Shader::find_uniform(const std::string& name) const {
+    auto it = uniform_locations.find(name);
+    return it == uniform_locations.end() ? -1 : it->second;
+}
 void Shader::setMat4(int loc, const glm::mat4& mat) const { glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mat)); }
 void Shader::setInt(int loc, int val) const { glUniform1i(loc, val); }
 void Shader::setFloat(int loc, float val) const { glUniform1f(loc, val); }
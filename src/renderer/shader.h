@@ -3,15 +3,22 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <vector>
+#include <unordered_map>
 
 class Shader {
 public:
+    // Uniform buffer binding point of the per-frame `FrameUniforms` block (see World::FrameUniforms).
+    static constexpr GLuint FRAME_UNIFORMS_BINDING = 0;
+
     unsigned int ID;
+    // A null fragmentPath links a vertex-only program (depth-only passes).
     Shader(const char* vertexPath, const char* fragmentPath);
     ~Shader();
     bool valid() const { return ID != 0; }
     void use();
-    int find_uniform(const std::string& name);
+    // Looked up in the locations cached at link time; no GL call. Arrays answer to both
+    // "name" and "name[0]". -1 for unknown names and uniform block members.
+    int find_uniform(const std::string& name) const;
     void setMat4(int location, const glm::mat4& mat) const;
     void setInt(int location, int value) const;
     void setFloat(int location, float value) const;
@@ -20,4 +27,8 @@ public:
     void setVec3(int location, const glm::vec3& value) const;
     void setMat4Array(int location, const std::vector<glm::mat4>& mats) const;
     void setFloatArray(int location, const std::vector<float>& values) const;
+
+private:
+    void cache_uniforms();
+    std::unordered_map<std::string, int> uniform_locations;
 };
@@ -34,6 +34,13 @@ int manhattan_distance_offset(const glm::ivec3& offset) {
 int ring_distance_offset(const glm::ivec3& offset) {
     return std::max(std::abs(offset.x), std::abs(offset.z));
 }
+// Index of a chunk-local position in the NBT "Blocks" array (Y fastest, then Z, then X).
+int32_t nbt_block_index(const glm::ivec3& lp) {
+    return lp.y + lp.z * CHUNK_HEIGHT + lp.x * CHUNK_HEIGHT * CHUNK_LENGTH;
+}
+glm::ivec3 nbt_block_position(int32_t index) {
+    return {index / (CHUNK_HEIGHT * CHUNK_LENGTH), index % CHUNK_HEIGHT, (index / CHUNK_HEIGHT) % CHUNK_LENGTH};
+}
 } // namespace
 
 bool Save::save_chunk(Chunk* chunk) {
@@ -55,10 +62,14 @@ bool Save::save_chunk(Chunk* chunk) {
 
     std::string filename = dir_path + "/c." + to_base36(x) + "." + to_base36(z) + ".dat";
 
+    std::vector<int32_t> emitters;
+    chunk->for_each_emitter([&](glm::ivec3 lp) { emitters.push_back(nbt_block_index(lp)); });
+
     bool success = NBT::write_blocks_to_gzip(
         filename,
         (const uint8_t*)chunk->blocks,
-        CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_LENGTH
+        CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_LENGTH,
+        &emitters
     );
 
     if (success) {
@@ -90,7 +101,7 @@ bool Save::load_chunk(const glm::ivec3& chunk_pos, bool eager_build) {
     if (!world) return false;
     if (world->chunks.find(chunk_pos) != world->chunks.end()) return false;
 
-    Chunk* c = new Chunk(world, chunk_pos);
+    Chunk* c = world->chunk_pool.acquire(chunk_pos);
     world->chunks[chunk_pos] = c;
 
     // Link neighbor pointers for fast access.
@@ -103,7 +114,18 @@ bool Save::load_chunk(const glm::ivec3& chunk_pos, bool eager_build) {
         if (n) n->neighbors[OPPOSITE[i]] = c;
     }
 
+    // Recently unloaded chunks come back from memory with their light intact;
+    // only the borders are stitched again.
+    if (world->compressed_chunks.take(chunk_pos, *c)) {
+        world->stitch_sky_light(c);
+        world->stitch_block_light(c);
+        finish_load(c, eager_build);
+        return true;
+    }
+
     bool loaded = false;
+    bool has_emitter_index = false;
+    std::vector<int32_t> emitters;
 
     // Try NBT (gzip) save first
     int x = chunk_pos.x;
@@ -112,7 +134,7 @@ bool Save::load_chunk(const glm::ivec3& chunk_pos, bool eager_build) {
     int rz = z % 64; if (rz < 0) rz += 64;
     std::string nbt_path = path + "/" + to_base36(rx) + "/" + to_base36(rz) + "/c." + to_base36(x) + "." + to_base36(z) + ".dat";
     if (fs::exists(nbt_path)) {
-        if (NBT::read_blocks_from_gzip(nbt_path, (uint8_t*)c->blocks, sizeof(c->blocks))) {
+        if (NBT::read_blocks_from_gzip(nbt_path, (uint8_t*)c->blocks, sizeof(c->blocks), &emitters, &has_emitter_index)) {
             loaded = true;
         }
     }
@@ -166,34 +188,33 @@ bool Save::load_chunk(const glm::ivec3& chunk_pos, bool eager_build) {
     world->init_skylight(c);
     world->stitch_sky_light(c);
 
-    // Initialize block light only for chunks loaded from save (fallback flat chunks have no emitters)
+    // Block light is seeded from the emitter index only (fallback flat chunks have no emitters).
+    // Saves that predate the "Emitters" tag, and legacy files, get one scan to build it.
     if (loaded) {
-        auto is_light_source = [&](int id) {
-            return world->light_blocks.count(id) != 0;
-        };
-
-        for (int lx = 0; lx < CHUNK_WIDTH; lx++) {
-            for (int ly = 0; ly < CHUNK_HEIGHT; ly++) {
-                for (int lz = 0; lz < CHUNK_LENGTH; lz++) {
-                    int id = c->blocks[lx][ly][lz];
-                    if (id == 0) continue;
-                    if (is_light_source(id)) {
-                        c->set_block_light({lx, ly, lz}, 15);
-                        glm::ivec3 global_pos = {
-                            c->chunk_position.x * CHUNK_WIDTH + lx,
-                            ly,
-                            c->chunk_position.z * CHUNK_LENGTH + lz
-                        };
-                        world->light_increase_queue.push_back({global_pos, 15});
-                    }
-                }
+        if (has_emitter_index) {
+            const BlockProperties& props = world->block_properties;
+            for (int32_t index : emitters) {
+                if (index < 0 || index >= CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_LENGTH) continue;
+                glm::ivec3 lp = nbt_block_position(index);
+                // Skip stale entries, e.g. after a block stopped emitting light.
+                if (props.emission(c->blocks[lp.x][lp.y][lp.z]) == 0) continue;
+                Subchunk& sc = c->subchunk_at(lp.x / SUBCHUNK_WIDTH, lp.y / SUBCHUNK_HEIGHT, lp.z / SUBCHUNK_LENGTH);
+                sc.emitters.push_back(Subchunk::pack_emitter(lp - sc.local_position));
             }
+        } else {
+            c->rebuild_emitter_index();
         }
+        c->seed_emitter_light();
     }
 
     // Stitch block light with neighbors
     world->stitch_block_light(c);
 
+    finish_load(c, eager_build);
+    return true;
+}
+
+void Save::finish_load(Chunk* c, bool eager_build) {
     if (eager_build) {
         world->propagate_skylight_increase(false, std::numeric_limits<int>::max());
         world->propagate_increase(false, std::numeric_limits<int>::max());
@@ -201,21 +222,14 @@ bool Save::load_chunk(const glm::ivec3& chunk_pos, bool eager_build) {
 
     c->update_subchunk_meshes();
 
-    auto update_neighbor = [&](glm::ivec3 offset) {
-        glm::ivec3 n_pos = c->chunk_position + offset;
-        auto it = world->chunks.find(n_pos);
-        if (it == world->chunks.end()) return;
-        Chunk* neighbor = it->second;
+    // Only the neighbours' sections that touch the shared edge can change.
+    static const int OPPOSITE[6] = {1, 0, 3, 2, 5, 4};
+    for (int i : {0, 1, 4, 5}) {
+        Chunk* neighbor = c->neighbors[i];
+        if (!neighbor) continue;
         neighbor->modified = true;
-        neighbor->update_subchunk_meshes();
-    };
-
-    update_neighbor(Util::EAST);
-    update_neighbor(Util::WEST);
-    update_neighbor(Util::NORTH);
-    update_neighbor(Util::SOUTH);
-
-    return true;
+        neighbor->update_border_subchunks(OPPOSITE[i]);
+    }
 }
 
 void Save::load(int initial_radius) {
@@ -229,6 +243,7 @@ void Save::load(int initial_radius) {
     world->light_increase_queue.clear();
     world->skylight_increase_queue.clear();
     pending_chunks.clear();
+    pending_chunks.rescore(viewer_at(world->player ? world->player->position : glm::vec3(0.0f)));
 
     const int radius = Options::RENDER_DISTANCE;
     const int max_initial = std::max(0, radius - 1);
@@ -256,42 +271,59 @@ void Save::load(int initial_radius) {
             load_chunk(chunk_pos, true);
             loaded_now++;
         } else {
-            pending_chunks.push_back(chunk_pos);
+            pending_chunks.push(chunk_pos);
         }
     }
 
     std::cout << "Loaded " << loaded_now << " chunks upfront, queued " << pending_chunks.size() << " for streaming." << std::endl;
 }
 
+ChunkLoadQueue::Viewer Save::viewer_at(glm::vec3 player_pos) const {
+    ChunkLoadQueue::Viewer v;
+    v.position = player_pos;
+    if (Player* p = world->player) {
+        v.velocity = p->velocity;
+        v.yaw = p->rotation.x;
+        v.has_view = true;
+        v.frustum = p;
+    }
+    return v;
+}
+
 void Save::update_streaming(glm::vec3 player_pos) {
     glm::ivec3 current_center = world->get_chunk_pos(player_pos);
+    ChunkLoadQueue::Viewer viewer = viewer_at(player_pos);
 
-    // No-op if player stays in the same chunk.
-    if (current_center == last_center_chunk) return;
+    // Same chunk: only re-order the queue if the player turned or moved enough.
+    if (current_center == last_center_chunk) {
+        pending_chunks.update_viewer(viewer);
+        return;
+    }
 
     last_center_chunk = current_center;
     int radius = Options::RENDER_DISTANCE;
 
     // --- QUEUE GENERATION AROUND PLAYER ---
+    auto out_of_range = [&](const glm::ivec3& pos) {
+        int dx = pos.x - current_center.x;
+        int dz = pos.z - current_center.z;
+        return dx * dx + dz * dz > radius * radius;
+    };
+    pending_chunks.remove_if(out_of_range);
+    pending_chunks.rescore(viewer);
+
     for (int x = -radius; x <= radius; x++) {
         for (int z = -radius; z <= radius; z++) {
-            if (x * x + z * z > radius * radius) continue;
-
             glm::ivec3 chunk_pos = current_center + glm::ivec3(x, 0, z);
+            if (out_of_range(chunk_pos)) continue;
 
-            // Skip if chunk already exists.
+            // Skip if chunk already exists; the queue ignores duplicates.
             if (world->chunks.find(chunk_pos) != world->chunks.end()) continue;
-
-            // Avoid duplicates in pending queue.
-            bool already_queued = false;
-            for (const auto& p : pending_chunks) {
-                if (p == chunk_pos) { already_queued = true; break; }
-            }
-            if (!already_queued) pending_chunks.push_back(chunk_pos);
+            pending_chunks.push(chunk_pos);
         }
     }
 
-    // --- UNLOAD FAR CHUNKS ---
+    // --- UNLOAD FAR CHUNKS, RE-TIER THE REST ---
     const int unload_dist_sq = (radius + 3) * (radius + 3);
 
     for (auto it = world->chunks.begin(); it != world->chunks.end(); ) {
@@ -313,13 +345,14 @@ void Save::update_streaming(glm::vec3 player_pos) {
                 if (n) n->neighbors[OPPOSITE[i]] = nullptr;
             }
 
-            auto& visible = world->visible_chunks;
-            visible.erase(std::remove(visible.begin(), visible.end(), c), visible.end());
+            world->remove_visible_chunk(c);
 
             auto& build_queue = world->chunk_building_queue;
             build_queue.erase(std::remove(build_queue.begin(), build_queue.end(), c), build_queue.end());
 
-            delete c;
+            c->evict_meshes_to_cache();
+            world->compressed_chunks.put(*c);
+            world->chunk_pool.release(c);
             it = world->chunks.erase(it);
         } else {
             ++it;
@@ -330,11 +363,9 @@ void Save::update_streaming(glm::vec3 player_pos) {
 void Save::stream_next(int max_chunks) {
     if (max_chunks <= 0) return;
     int loaded = 0;
-    while (loaded < max_chunks && !pending_chunks.empty()) {
-        glm::ivec3 pos = pending_chunks.front();
-        pending_chunks.pop_front();
-        load_chunk(pos, false);
-        loaded++;
+    glm::ivec3 pos;
+    while (loaded < max_chunks && pending_chunks.pop(pos)) {
+        if (load_chunk(pos, false)) loaded++;
     }
     if (pending_chunks.empty() && loaded > 0) {
         std::cout << "Chunk streaming finished." << std::endl;
@@ -1,7 +1,7 @@
 #pragma once
 #include <string>
-#include <deque>
 #include <glm/glm.hpp>
+#include "chunk/chunk_load_queue.h"
 
 class World;
 class Chunk;
@@ -19,10 +19,15 @@ public:
     void update_streaming(glm::vec3 player_pos);
     void stream_next(int max_chunks = 1);
     bool has_pending_chunks() const { return !pending_chunks.empty(); }
+    size_t pending_chunk_count() const { return pending_chunks.size(); }
 
 private:
     bool load_chunk(const glm::ivec3& pos, bool eager_build);
+    // Shared tail of load_chunk: optional eager relight, then queue meshes for the chunk and its edges.
+    void finish_load(Chunk* c, bool eager_build);
     bool save_chunk(Chunk* chunk);
-    std::deque<glm::ivec3> pending_chunks;
+    // Look-ahead state for load ordering; direction and frustum come from world->player when set.
+    ChunkLoadQueue::Viewer viewer_at(glm::vec3 player_pos) const;
+    ChunkLoadQueue pending_chunks;
     glm::ivec3 last_center_chunk = glm::ivec3(999999);
 };
@@ -1,4 +1,5 @@
 #include "text_renderer.h"
+#include "renderer/gl_state.h"
 #include <iostream>
 #include <vector>
 #include <fstream>
@@ -41,9 +42,9 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
 }
 
 TextRenderer::~TextRenderer() {
-    glDeleteVertexArrays(1, &VAO);
+    GLState::delete_vertex_arrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram);
+    GLState::delete_program(shaderProgram);
 }
 
 void TextRenderer::SetScreenSize(unsigned int width, unsigned int height) {
@@ -117,22 +118,22 @@ void TextRenderer::Load(std::string fontPath, unsigned int fontSize) {
 void TextRenderer::initRenderData() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GLState::bind_vertex_array(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bind_vertex_array(0);
 }
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color) {
-    glUseProgram(shaderProgram);
+    GLState::use_program(shaderProgram);
     glUniform3f(glGetUniformLocation(shaderProgram, "textColor"), color.x, color.y, color.z);
     glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
 
     glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    GLState::bind_vertex_array(VAO);
 
     // Округляем начальную позицию для pixel-perfect рендера
     x = std::floor(x);
@@ -195,6 +196,6 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
 
         x += std::floor(ch.Advance * scale);
     }
-    glBindVertexArray(0);
+    GLState::bind_vertex_array(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
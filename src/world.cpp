@@ -1,4 +1,5 @@
 #include "world.h"
+#include "renderer/gl_state.h"
 #include <fstream>
 #include <iostream>
 #include <algorithm>
@@ -7,19 +8,25 @@
 #include <glm/gtx/norm.hpp>
 #include <limits>
 #include <cmath>
+#include <bit>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 World::World(Shader* s, TextureManager* tm, Player* p) : shader(s), texture_manager(tm), player(p) {
+    mesh_cache.set_capacity(Options::MESH_CACHE_SIZE);
+    compressed_chunks.set_budget(static_cast<size_t>(Options::CHUNK_CACHE_BUDGET_MB) * 1024 * 1024);
 #ifndef UNIT_TEST
-    shader_daylight_loc = -1;
     if (shader && shader->valid()) {
+        // Samplers never change units, so they are set once here rather than every frame.
         shader->use();
-        shader_daylight_loc = shader->find_uniform("u_Daylight");
-        // Ensure shadows are disabled in the main shader by default
-        shader_cascade_count_loc = shader->find_uniform("u_ShadowCascadeCount");
-        if (shader_cascade_count_loc >= 0) shader->setInt(shader_cascade_count_loc, 0);
+        shader->setInt(shader->find_uniform("u_TextureArraySampler"), 0);
+        shader->setInt(shader->find_uniform("u_ShadowMap"), 1);
     }
+    glGenBuffers(1, &frame_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, frame_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, Shader::FRAME_UNIFORMS_BINDING, frame_ubo);
 
     std::vector<unsigned int> indices;
     for (int i=0; i<CHUNK_WIDTH*CHUNK_HEIGHT*CHUNK_LENGTH*8; i++) {
@@ -29,6 +36,16 @@ World::World(Shader* s, TextureManager* tm, Player* p) : shader(s), texture_mana
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
+    if (shader && shader->valid()) {
+        depth_prepass_shader = new Shader("assets/shaders/depth_prepass/vert.glsl", nullptr);
+        depth_prepass_cutout_shader = new Shader("assets/shaders/depth_prepass/vert.glsl", "assets/shaders/shadow/frag.glsl");
+        if (!depth_prepass_shader->valid() || !depth_prepass_cutout_shader->valid()) {
+            delete depth_prepass_shader;
+            delete depth_prepass_cutout_shader;
+            depth_prepass_shader = depth_prepass_cutout_shader = nullptr;
+        }
+    }
+
     shadows_enabled = Options::SHADOWS_ENABLED;
     if (shadows_enabled && shader && shader->valid() && texture_manager) {
         if (!init_shadow_resources()) {
@@ -40,15 +57,24 @@ World::World(Shader* s, TextureManager* tm, Player* p) : shader(s), texture_mana
 World::~World() {
 #ifndef UNIT_TEST
     if (ibo) glDeleteBuffers(1, &ibo);
+    if (frame_ubo) glDeleteBuffers(1, &frame_ubo);
 #endif
     for(auto& kv : chunks) delete kv.second;
+    chunk_pool.clear();
+    vbo_pool.clear();
     if(save_system) delete save_system;
 #ifndef UNIT_TEST
     if (shadow_fbo) glDeleteFramebuffers(1, &shadow_fbo);
     if (shadow_map) glDeleteTextures(1, &shadow_map);
     if (shadow_shader) delete shadow_shader;
+    if (shadow_caster_shader) delete shadow_caster_shader;
+    delete depth_prepass_shader;
+    delete depth_prepass_cutout_shader;
 #endif
 }
+void World::build_block_properties() {
+    block_properties.build(block_types, light_blocks);
+}
 glm::ivec3 World::get_chunk_pos(glm::vec3 pos) { return glm::ivec3(floor(pos.x/16), floor(pos.y/128), floor(pos.z/16)); }
 glm::ivec3 World::get_local_pos(glm::vec3 pos) {
     int x = (int)floor(pos.x) % 16; if(x<0) x+=16;
@@ -68,7 +94,7 @@ void World::set_block(glm::ivec3 pos, int number) {
     glm::ivec3 cp = get_chunk_pos(glm::vec3(pos));
     if(chunks.find(cp) == chunks.end()) {
         if(number == 0) return;
-        chunks[cp] = new Chunk(this, cp);
+        chunks[cp] = chunk_pool.acquire(cp);
         init_skylight(chunks[cp]);
         stitch_sky_light(chunks[cp]);
         stitch_block_light(chunks[cp]);
@@ -77,23 +103,35 @@ void World::set_block(glm::ivec3 pos, int number) {
     Chunk* c = chunks[cp];
     if(c->blocks[lp.x][lp.y][lp.z] == number) return;
 
+    if (batch_depth > 0) {
+        // Raw write; lighting and remesh triggers run once in commit().
+        if (batch_positions.insert(pos).second) {
+            batch_edits.push_back({pos, static_cast<uint8_t>(c->get_block_light(lp)), static_cast<uint8_t>(c->get_sky_light(lp))});
+        }
+        c->set_block_id(lp, number);
+        c->modified = true;
+        c->last_edit_time = time;
+        return;
+    }
+
     int old_sky_light = get_skylight(pos);
 
-    c->blocks[lp.x][lp.y][lp.z] = number;
+    c->set_block_id(lp, number);
     c->modified = true;
+    c->last_edit_time = time;
     c->update_at_position(lp);
 
-    bool now_opaque = (number != 0 && !block_types[number]->transparent);
-    bool is_source = (number != 0 && light_blocks.find(number) != light_blocks.end());
+    bool now_opaque = block_properties.is_opaque(number);
+    int emission = block_properties.emission(number);
 
     // 1. Block Light
-    if (is_source) {
-        increase_light(pos, 15);
+    if (emission > 0) {
+        increase_light(pos, emission);
     } else if (get_light(pos) > 0) {
         decrease_light(pos);
     }
     // Если блок сломали, свет от соседей должен заполнить пустоту
-    else if (number == 0 || block_types[number]->transparent) {
+    else if (block_properties.is_transparent(number)) {
         for(auto& d : Util::DIRECTIONS) {
             glm::ivec3 n = pos + d;
             int l = get_light(n);
@@ -137,6 +175,10 @@ void World::set_block(glm::ivec3 pos, int number) {
         }
     }
 
+    mark_neighbour_chunks_dirty(cp, lp);
+}
+
+void World::mark_neighbour_chunks_dirty(glm::ivec3 cp, glm::ivec3 lp) {
     if(lp.x==0 && chunks.count(cp+Util::WEST)) chunks[cp+Util::WEST]->update_at_position(lp+glm::ivec3(15,0,0));
     if(lp.x==15 && chunks.count(cp+Util::EAST)) chunks[cp+Util::EAST]->update_at_position(lp-glm::ivec3(15,0,0));
     if(lp.y==0 && chunks.count(cp+Util::DOWN)) chunks[cp+Util::DOWN]->update_at_position(lp+glm::ivec3(0,127,0));
@@ -145,19 +187,131 @@ void World::set_block(glm::ivec3 pos, int number) {
     if(lp.z==15 && chunks.count(cp+Util::SOUTH)) chunks[cp+Util::SOUTH]->update_at_position(lp-glm::ivec3(0,0,15));
 }
 
+void World::begin_batch() {
+    batch_depth++;
+}
+
+void World::set_blocks(std::span<const BlockEdit> edits) {
+    begin_batch();
+    for (const BlockEdit& e : edits) set_block(e.pos, e.number);
+    commit();
+}
+
+void World::commit() {
+    if (batch_depth <= 0 || --batch_depth > 0) return;
+
+    std::vector<BatchedEdit> edits;
+    edits.swap(batch_edits);
+    batch_positions.clear();
+    const int unbounded = std::numeric_limits<int>::max();
+    // The batch relights to completion; streaming and earlier edits stay budgeted.
+    std::deque<std::pair<glm::ivec3, int>> parked[4];
+    swap_light_queues(parked);
+
+    // Pass 1: take light away where blocks now occlude it or emitters were removed,
+    // and let all the decreases run before anything is refilled.
+    for (const BatchedEdit& e : edits) {
+        Chunk* c = chunks[get_chunk_pos(glm::vec3(e.pos))];
+        glm::ivec3 lp = get_local_pos(glm::vec3(e.pos));
+        int number = c->blocks[lp.x][lp.y][lp.z];
+        if (block_properties.emission(number) == 0 && e.old_light > 0) {
+            c->set_block_light(lp, 0);
+            light_decrease_queue.push_back({e.pos, e.old_light});
+        }
+        if (block_properties.is_opaque(number) && e.old_sky > 0) {
+            c->set_sky_light(lp, 0);
+            skylight_decrease_queue.push_back({e.pos, e.old_sky});
+        }
+    }
+    propagate_decrease(true, unbounded);
+    propagate_skylight_decrease(true, unbounded);
+
+    // A decrease queues the brighter cells at its edge as refill sources, but a
+    // later decrease in the same pass may have cleared them. Drop those.
+    std::erase_if(light_increase_queue, [&](const auto& e) { return get_light(e.first) < e.second; });
+    std::erase_if(skylight_increase_queue, [&](const auto& e) { return get_skylight(e.first) < e.second; });
+
+    // Pass 2: new emitters and light flowing into opened space.
+    for (const BatchedEdit& e : edits) {
+        glm::ivec3 cp = get_chunk_pos(glm::vec3(e.pos));
+        Chunk* c = chunks[cp];
+        glm::ivec3 lp = get_local_pos(glm::vec3(e.pos));
+        int number = c->blocks[lp.x][lp.y][lp.z];
+        int emission = block_properties.emission(number);
+        if (emission > 0) {
+            c->set_block_light(lp, emission);
+            light_increase_queue.push_back({e.pos, emission});
+        }
+        if (!block_properties.is_opaque(number)) {
+            for (auto& d : Util::DIRECTIONS) {
+                glm::ivec3 n = e.pos + d;
+                int l = get_light(n);
+                if (l > 0) light_increase_queue.push_back({n, l});
+                if (n.y >= CHUNK_HEIGHT) {
+                    skylight_increase_queue.push_back({n, 15});
+                } else {
+                    int sl = get_skylight(n);
+                    if (sl > 0) skylight_increase_queue.push_back({n, sl});
+                }
+            }
+        }
+        c->update_at_position(lp);
+        mark_neighbour_chunks_dirty(cp, lp);
+    }
+    propagate_increase(true, unbounded);
+    propagate_skylight_increase(true, unbounded);
+    swap_light_queues(parked);
+}
+
+void World::swap_light_queues(std::deque<std::pair<glm::ivec3, int>> (&parked)[4]) {
+    light_increase_queue.swap(parked[0]);
+    light_decrease_queue.swap(parked[1]);
+    skylight_increase_queue.swap(parked[2]);
+    skylight_decrease_queue.swap(parked[3]);
+}
+
 bool World::try_set_block(glm::ivec3 pos, int number, const Collider& player_collider) {
     if (pos.y < 0 || pos.y >= CHUNK_HEIGHT) return false;
-    if (number == 0) { set_block(pos, 0); return true; }
+    if (number == 0) { apply_player_edit(pos, 0); return true; }
     if (number < block_types.size() && block_types[number]) {
         for (const auto& block_col : block_types[number]->colliders) {
             Collider world_col = block_col + glm::vec3(pos);
             if (world_col & player_collider) return false;
         }
     }
-    set_block(pos, number);
+    apply_player_edit(pos, number);
     return true;
 }
 
+void World::apply_player_edit(glm::ivec3 pos, int number) {
+    // Park the background light backlog (streaming, earlier edits) so this
+    // edit's relight runs first and to completion.
+    std::deque<std::pair<glm::ivec3, int>> parked[4];
+    swap_light_queues(parked);
+
+    std::vector<std::pair<Chunk*, int>> touched;
+    edit_capture = &touched;
+    set_block(pos, number);
+    const int unbounded = std::numeric_limits<int>::max();
+    while (!light_decrease_queue.empty() || !light_increase_queue.empty() ||
+           !skylight_decrease_queue.empty() || !skylight_increase_queue.empty()) {
+        propagate_decrease(true, unbounded);
+        propagate_increase(true, unbounded);
+        propagate_skylight_decrease(true, unbounded);
+        propagate_skylight_increase(true, unbounded);
+    }
+    edit_capture = nullptr;
+    swap_light_queues(parked);
+
+    std::sort(touched.begin(), touched.end());
+    for (size_t i = 0; i < touched.size(); ) {
+        Chunk* c = touched[i].first;
+        uint32_t mask = 0;
+        for (; i < touched.size() && touched[i].first == c; i++) mask |= 1u << touched[i].second;
+        c->rebuild_sections_now(mask);
+    }
+}
+
 int World::get_light(glm::ivec3 pos) {
     glm::ivec3 cp = get_chunk_pos(glm::vec3(pos)); if(chunks.find(cp)==chunks.end()) return 0;
     return chunks[cp]->get_block_light(get_local_pos(glm::vec3(pos)));
@@ -172,10 +326,10 @@ int World::get_skylight(glm::ivec3 pos) {
     return it->second->get_sky_light(get_local_pos(glm::vec3(pos)));
 }
 bool World::is_opaque_block(glm::ivec3 pos) {
-    int n = get_block_number(pos); if(!n) return false; return !block_types[n]->transparent;
+    return block_properties.is_opaque(get_block_number(pos));
 }
 bool World::get_transparency(glm::ivec3 pos) {
-    int n = get_block_number(pos); if(!n) return true; return block_types[n]->transparent;
+    return block_properties.is_transparent(get_block_number(pos));
 }
 
 void World::increase_light(glm::ivec3 pos, int val, bool update) {
@@ -231,7 +385,7 @@ void World::init_skylight(Chunk* c) {
         for(int z=0; z<CHUNK_LENGTH; z++) {
             int height = -1;
             for(int y = CHUNK_HEIGHT - 1; y >= 0; y--) {
-                if(c->blocks[x][y][z] != 0 && is_opaque_block({global_base.x+x, y, global_base.z+z})) {
+                if(block_properties.is_opaque(c->blocks[x][y][z])) {
                     height = y;
                     break;
                 }
@@ -250,8 +404,7 @@ void World::init_skylight(Chunk* c) {
 
     // 2. Border Pass
     auto check_border_neighbor = [&](glm::ivec3 local_pos, glm::ivec3 global_neighbor_pos) {
-        if (c->blocks[local_pos.x][local_pos.y][local_pos.z] != 0 &&
-            !block_types[c->blocks[local_pos.x][local_pos.y][local_pos.z]]->transparent) return;
+        if (block_properties.is_opaque(c->blocks[local_pos.x][local_pos.y][local_pos.z])) return;
 
         int neighbor_light = get_skylight(global_neighbor_pos);
         int current_light = c->get_sky_light(local_pos);
@@ -290,13 +443,9 @@ void World::propagate_skylight_increase(bool update, int max_steps) {
             if(chunks.find(get_chunk_pos(glm::vec3(n))) == chunks.end()) continue;
 
             int block_id = get_block_number(n);
-            int decay = 1;
-            if (d.y == -1) {
-                decay = 0;
-                if (block_id != 0 && !block_types[block_id]->glass) decay = 1;
-            }
+            int decay = (d.y == -1) ? block_properties.opacity(block_id) : 1;
 
-            if(!is_opaque_block(n)) {
+            if(!block_properties.is_opaque(block_id)) {
                 int nl = get_skylight(n); int new_l = level - decay;
                 if (new_l > nl && new_l > 0) {
                     chunks[get_chunk_pos(glm::vec3(n))]->set_sky_light(get_local_pos(glm::vec3(n)), new_l);
@@ -328,7 +477,8 @@ void World::propagate_skylight_decrease(bool update, int max_steps) {
 }
 void World::speed_daytime() { if(daylight <= 480) incrementer = 1; if(daylight >= 1800) incrementer = -1; }
 glm::vec3 World::get_light_direction() const {
-    double phase = std::fmod(static_cast<double>(time) + 9000.0, 36000.0) / 36000.0;
+    long step = std::max(1, Options::SHADOW_SUN_STEP_TICKS);
+    double phase = std::fmod(static_cast<double>(time - time % step) + 9000.0, 36000.0) / 36000.0;
     double azimuth = phase * glm::two_pi<double>();
     float elevation = glm::mix(0.2f, 0.85f, static_cast<float>(0.5 * (std::sin(azimuth) + 1.0)));
     return glm::normalize(glm::vec3(static_cast<float>(std::cos(azimuth)), -elevation, static_cast<float>(std::sin(azimuth))));
@@ -336,16 +486,51 @@ glm::vec3 World::get_light_direction() const {
 float World::get_daylight_factor() const {
     return std::clamp(daylight / 1800.0f, 0.0f, 1.0f);
 }
+void World::link_dirty_chunk(Chunk* c) {
+    if (c->in_dirty_list) return;
+    c->in_dirty_list = true;
+    c->dirty_prev = dirty_chunks_tail;
+    c->dirty_next = nullptr;
+    if (dirty_chunks_tail) dirty_chunks_tail->dirty_next = c;
+    else dirty_chunks_head = c;
+    dirty_chunks_tail = c;
+}
+
+void World::unlink_dirty_chunk(Chunk* c) {
+    if (!c->in_dirty_list) return;
+    if (c->dirty_prev) c->dirty_prev->dirty_next = c->dirty_next;
+    else dirty_chunks_head = c->dirty_next;
+    if (c->dirty_next) c->dirty_next->dirty_prev = c->dirty_prev;
+    else dirty_chunks_tail = c->dirty_prev;
+    c->dirty_prev = c->dirty_next = nullptr;
+    c->in_dirty_list = false;
+}
+
+World::MeshMemory World::mesh_memory() const {
+    MeshMemory m;
+    for (const auto& kv : chunks) {
+        const Chunk* c = kv.second;
+        for (const Subchunk& sc : c->subchunks) {
+            m.cpu_bytes += (sc.mesh.capacity() + sc.translucent_mesh.capacity()) * sizeof(uint32_t);
+            m.caster_bytes += sc.caster_mesh.capacity() * sizeof(uint32_t);
+        }
+        m.gpu_bytes += (c->vbo_capacity + c->caster_capacity) * sizeof(uint32_t);
+    }
+    m.gpu_bytes += vbo_pool.bytes();
+    m.pool_bytes = mesh_pool.bytes();
+    m.cpu_bytes += m.pool_bytes;
+    return m;
+}
+
 void World::tick(float dt) {
-    chunk_update_counter = 0; time++; pending_chunk_update_count = 0;
+    chunk_update_counter = 0; mesh_rebuilds_skipped = 0; time++; pending_chunk_update_count = 0;
 
     // Day/night cycle: smooth sinusoidal between dawn and noon values
     double phase = std::fmod(static_cast<double>(time) + 9000.0, 36000.0) / 36000.0;
     float sun_height = static_cast<float>(0.5 * (std::sin(phase * glm::two_pi<double>()) + 1.0));
     daylight = glm::mix(480.0f, 1800.0f, sun_height);
 
-    if(!chunk_building_queue.empty()) { chunk_building_queue.front()->update_mesh(); chunk_building_queue.pop_front(); }
-    for(auto* c : visible_chunks) c->process_chunk_updates();
+    remesh_scheduler.run(Options::REMESH_BUDGET_US);
     propagate_increase(true);
     propagate_decrease(true);
     propagate_skylight_increase(true);
@@ -414,18 +599,88 @@ void World::prepare_rendering() {
 #ifdef UNIT_TEST
     return;
 #endif
-    visible_chunks.clear();
-    std::vector<std::pair<float, Chunk*>> candidates;
-    candidates.reserve(chunks.size());
-    glm::vec3 player_pos = player->position;
-    for(auto& kv : chunks) {
-        glm::vec3 center = kv.second->position + glm::vec3(CHUNK_WIDTH * 0.5f, CHUNK_HEIGHT * 0.5f, CHUNK_LENGTH * 0.5f);
-        float dist2 = glm::length2(player_pos - center);
-        candidates.push_back({dist2, kv.second});
+    update_render_order(player->position);
+    update_translucent_order(player->interpolated_position + glm::vec3(0, player->eyelevel, 0));
+}
+
+void World::update_render_order(const glm::vec3& eye) {
+    auto distance2 = [&](const Chunk* c) {
+        glm::vec3 center = c->position + glm::vec3(CHUNK_WIDTH * 0.5f, CHUNK_HEIGHT * 0.5f, CHUNK_LENGTH * 0.5f);
+        return glm::length2(eye - center);
+    };
+    glm::ivec3 eye_chunk = get_chunk_pos(eye);
+    // Unloads go through remove_visible_chunk, so a size mismatch means new chunks.
+    if (visible_chunks.size() != chunks.size() || visible_distances.size() != visible_chunks.size() ||
+        eye_chunk != render_order_chunk) {
+        std::vector<std::pair<float, Chunk*>> candidates;
+        candidates.reserve(chunks.size());
+        for (auto& kv : chunks) candidates.push_back({distance2(kv.second), kv.second});
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+        visible_chunks.clear();
+        visible_distances.clear();
+        for (auto& c : candidates) {
+            visible_distances.push_back(c.first);
+            visible_chunks.push_back(c.second);
+        }
+        render_order_chunk = eye_chunk;
+        render_order_full_sorts++;
+        return;
+    }
+
+    // Inside one chunk the order barely changes, and insertion sort is linear on nearly sorted input.
+    for (size_t i = 0; i < visible_chunks.size(); i++) visible_distances[i] = distance2(visible_chunks[i]);
+    for (size_t i = 1; i < visible_chunks.size(); i++) {
+        float d = visible_distances[i];
+        Chunk* c = visible_chunks[i];
+        size_t j = i;
+        for (; j > 0 && visible_distances[j - 1] > d; j--) {
+            visible_distances[j] = visible_distances[j - 1];
+            visible_chunks[j] = visible_chunks[j - 1];
+        }
+        visible_distances[j] = d;
+        visible_chunks[j] = c;
     }
-    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b){ return a.first > b.first; });
-    visible_chunks.reserve(candidates.size());
-    for (auto& c : candidates) visible_chunks.push_back(c.second);
+}
+
+void World::update_translucent_order(const glm::vec3& eye) {
+    TranslucentSorter::Result result;
+    while (translucent_sorter.poll(result)) {
+        auto it = chunks.find(result.chunk);
+        // Unloaded, or the position was reused by a pooled chunk since.
+        if (it == chunks.end() || it->second->sort_job != result.id) continue;
+        Chunk* c = it->second;
+        c->sort_job = 0;
+        // The quads moved while it was sorting; queued again below.
+        if (result.generation != c->translucent_generation) continue;
+        c->upload_translucent_order(result.indices);
+        c->sorted_generation = result.generation;
+    }
+
+    for (size_t i = 0; i < visible_chunks.size(); i++) {
+        Chunk* c = visible_chunks[i];
+        if (!c->translucent_quad_count || c->sort_job) continue;
+        if (c->sorted_generation == c->translucent_generation) {
+            float distance = i < visible_distances.size() ? std::sqrt(visible_distances[i]) : 0.0f;
+            float threshold = TRANSLUCENT_RESORT_DISTANCE + TRANSLUCENT_RESORT_SLOPE * distance;
+            if (glm::length2(eye - c->sort_eye) < threshold * threshold) continue;
+        }
+        TranslucentSorter::Job job;
+        c->gather_translucent_quads(job.quads);
+        if (job.quads.empty()) continue;
+        job.chunk = c->chunk_position;
+        job.generation = c->translucent_generation;
+        job.eye = eye - c->position;
+        c->sort_eye = eye;
+        c->sort_job = translucent_sorter.submit(std::move(job));
+    }
+}
+
+void World::remove_visible_chunk(Chunk* chunk) {
+    auto it = std::find(visible_chunks.begin(), visible_chunks.end(), chunk);
+    if (it == visible_chunks.end()) return;
+    size_t i = it - visible_chunks.begin();
+    visible_chunks.erase(it);
+    if (i < visible_distances.size()) visible_distances.erase(visible_distances.begin() + i);
 }
 
 bool World::init_shadow_resources() {
@@ -439,6 +694,8 @@ bool World::init_shadow_resources() {
 
     shadow_matrices.resize(shadow_cascade_count);
     shadow_splits.resize(shadow_cascade_count);
+    shadow_caster_counts.assign(shadow_cascade_count, 0);
+    shadow_cascades.assign(shadow_cascade_count, {});
 
     shadow_shader = new Shader("assets/shaders/shadow/vert.glsl", "assets/shaders/shadow/frag.glsl");
     if (!shadow_shader->valid()) {
@@ -447,6 +704,12 @@ bool World::init_shadow_resources() {
         std::cout << "ERROR::SHADOW:: Failed to load shadow shader." << std::endl;
         return false;
     }
+    // Depth-only program for merged solid casters; without it the full meshes are drawn.
+    shadow_caster_shader = new Shader("assets/shaders/shadow/caster_vert.glsl", nullptr);
+    if (!shadow_caster_shader->valid()) {
+        delete shadow_caster_shader;
+        shadow_caster_shader = nullptr;
+    }
 
     glGenFramebuffers(1, &shadow_fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, shadow_fbo);
@@ -456,8 +719,11 @@ bool World::init_shadow_resources() {
     glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24,
                  shadow_map_resolution, shadow_map_resolution, shadow_cascade_count,
                  0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // Comparison sampling: each lookup returns a bilinearly filtered 2x2 PCF result.
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
@@ -472,23 +738,12 @@ bool World::init_shadow_resources() {
         glDeleteFramebuffers(1, &shadow_fbo); shadow_fbo = 0;
         glDeleteTextures(1, &shadow_map); shadow_map = 0;
         delete shadow_shader; shadow_shader = nullptr;
+        delete shadow_caster_shader; shadow_caster_shader = nullptr;
         return false;
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // Cache uniform locations on the main shader
-    if (shader && shader->valid()) {
-        shader_shadow_map_loc = shader->find_uniform("u_ShadowMap");
-        shader_light_space_mats_loc = shader->find_uniform("u_LightSpaceMatrices[0]");
-        shader_cascade_splits_loc = shader->find_uniform("u_CascadeSplits");
-        shader_cascade_count_loc = shader->find_uniform("u_ShadowCascadeCount");
-        shader_shadow_texel_size_loc = shader->find_uniform("u_ShadowTexelSize");
-        shader_shadow_min_bias_loc = shader->find_uniform("u_ShadowMinBias");
-        shader_shadow_slope_bias_loc = shader->find_uniform("u_ShadowSlopeBias");
-        shader_shadow_pcf_radius_loc = shader->find_uniform("u_ShadowPCFRadius");
-    }
-
     return true;
 }
 
@@ -522,6 +777,7 @@ void World::update_shadow_cascades() {
 
     glm::mat4 invView = glm::inverse(player->mv_matrix);
     glm::vec3 lightDir = glm::normalize(get_light_direction());
+    const float margin = Options::SHADOW_CASCADE_MARGIN;
 
     for (int i = 0; i < shadow_cascade_count; ++i) {
         float prevSplit = (i == 0) ? near_plane : shadow_splits[i - 1];
@@ -558,15 +814,75 @@ void World::update_shadow_cascades() {
         }
         radius = std::max(radius, 1.0f);
         radius = std::ceil(radius * 16.0f) / 16.0f;
-
-        glm::vec3 lightPos = center - lightDir * (radius * 2.0f);
-        glm::mat4 lightView = glm::lookAt(lightPos, center, glm::vec3(0.0f, 1.0f, 0.0f));
+        // Keep the cached fit while it still contains this frame's slice and isn't much too big;
+        // new fits get a margin so the camera can move a little before the next one.
+        ShadowCascade& sc = shadow_cascades[i];
+        bool covered = glm::distance(sc.center, center) + radius <= sc.radius && sc.radius <= radius + 2.0f * margin;
+        if (sc.light_dir == lightDir && covered) continue;
+        radius += margin;
+
+        // Snap the centre to whole shadow-map texels in light space so re-fits don't shimmer.
+        glm::mat4 lightRot = glm::lookAt(glm::vec3(0.0f), lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
+        float texel = 2.0f * radius / static_cast<float>(shadow_map_resolution);
+        glm::vec3 lightCenter = glm::vec3(lightRot * glm::vec4(center, 1.0f));
+        lightCenter.x = std::floor(lightCenter.x / texel) * texel;
+        lightCenter.y = std::floor(lightCenter.y / texel) * texel;
+        glm::vec3 snapped = glm::vec3(glm::inverse(lightRot) * glm::vec4(lightCenter, 1.0f));
+
+        glm::vec3 lightPos = snapped - lightDir * (radius * 2.0f);
+        glm::mat4 lightView = glm::lookAt(lightPos, snapped, glm::vec3(0.0f, 1.0f, 0.0f));
 
         float zNear = 0.1f;
         float zFar = radius * 4.0f;
         glm::mat4 lightProj = glm::ortho(-radius, radius, -radius, radius, zNear, zFar);
 
-        shadow_matrices[i] = lightProj * lightView;
+        sc.center = center;
+        sc.radius = radius;
+        sc.light_dir = lightDir;
+        sc.target = lightProj * lightView;
+        sc.refit = true;
+    }
+}
+
+namespace {
+    // Box against a cascade's light-space volume, open toward the light.
+    bool casts_into(const glm::mat4& light_space, glm::vec3 lo, glm::vec3 hi) {
+        glm::vec3 mn(std::numeric_limits<float>::max());
+        glm::vec3 mx(std::numeric_limits<float>::lowest());
+        for (int k = 0; k < 8; k++) {
+            glm::vec3 corner((k & 1) ? hi.x : lo.x, (k & 2) ? hi.y : lo.y, (k & 4) ? hi.z : lo.z);
+            glm::vec3 p = glm::vec3(light_space * glm::vec4(corner, 1.0f));
+            mn = glm::min(mn, p);
+            mx = glm::max(mx, p);
+        }
+        return mx.x >= -1.0f && mn.x <= 1.0f && mx.y >= -1.0f && mn.y <= 1.0f && mn.z <= 1.0f;
+    }
+}
+
+void World::collect_shadow_casters(const glm::mat4& light_space, std::vector<ShadowCaster>& out) const {
+    out.clear();
+    auto overlaps = [&](glm::vec3 lo, glm::vec3 hi) { return casts_into(light_space, lo, hi); };
+
+    const glm::vec3 chunk_size(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_LENGTH);
+    const glm::vec3 section_size(SUBCHUNK_WIDTH, SUBCHUNK_HEIGHT, SUBCHUNK_LENGTH);
+    for (Chunk* c : visible_chunks) {
+        uint32_t sections = c->opaque_section_mask();
+        if (!sections || !overlaps(c->position, c->position + chunk_size)) continue;
+        uint32_t mask = 0;
+        for (uint32_t m = sections; m; m &= m - 1) {
+            int i = std::countr_zero(m);
+            glm::vec3 lo = c->subchunks[i].position;
+            if (overlaps(lo, lo + section_size)) mask |= 1u << i;
+        }
+        if (mask) out.push_back({c, mask});
+    }
+}
+
+void World::note_shadow_caster_change(const Chunk* c) {
+    glm::vec3 hi = c->position + glm::vec3(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_LENGTH);
+    for (size_t i = 0; i < shadow_cascades.size(); i++) {
+        ShadowCascade& sc = shadow_cascades[i];
+        if (sc.rendered && !sc.dirty && casts_into(shadow_matrices[i], c->position, hi)) sc.dirty = true;
     }
 }
 
@@ -578,8 +894,21 @@ void World::render_shadows() {
     if (shadow_cascade_count <= 0) return;
     if (visible_chunks.empty()) return;
 
+    shadow_frame++;
     update_shadow_cascades();
 
+    // Re-render only stale cascades; past the first, each gets one slot every N frames.
+    const int interval = std::max(1, Options::SHADOW_FAR_CASCADE_INTERVAL);
+    uint32_t render_mask = 0;
+    for (int i = 0; i < shadow_cascade_count; ++i) {
+        const ShadowCascade& sc = shadow_cascades[i];
+        if (!sc.refit && !sc.dirty) continue;
+        if (i > 0 && sc.rendered && shadow_frame % interval != (i - 1) % interval) continue;
+        render_mask |= 1u << i;
+    }
+    shadow_cascades_rendered = std::popcount(render_mask);
+    if (!render_mask) return;
+
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
     GLint prevDrawBuffer = GL_BACK;
@@ -592,8 +921,11 @@ void World::render_shadows() {
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 
-    glEnable(GL_DEPTH_TEST);
+    GLState::enable(GL_DEPTH_TEST);
     glCullFace(GL_BACK);
+    // Casters between the light and a cascade's near plane are culled in only by their
+    // far side; clamp their depth instead of clipping them.
+    GLState::enable(GL_DEPTH_CLAMP);
 
     shadow_shader->use();
     int chunkLoc = shadow_shader->find_uniform("u_ChunkPosition");
@@ -604,17 +936,49 @@ void World::render_shadows() {
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture_manager->texture_array);
 
+    int casterChunkLoc = -1, casterLightSpaceLoc = -1;
+    if (shadow_caster_shader) {
+        casterChunkLoc = shadow_caster_shader->find_uniform("u_ChunkPosition");
+        casterLightSpaceLoc = shadow_caster_shader->find_uniform("u_LightSpaceMatrix");
+    }
+
     for (int i = 0; i < shadow_cascade_count; ++i) {
+        if (!(render_mask & (1u << i))) continue;
+        ShadowCascade& sc = shadow_cascades[i];
+        shadow_matrices[i] = sc.target;
+        sc.refit = sc.dirty = false;
+        sc.rendered = true;
+
         glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_map, 0, i);
         glClear(GL_DEPTH_BUFFER_BIT);
 
-        if (lightSpaceLoc >= 0) shadow_shader->setMat4(lightSpaceLoc, shadow_matrices[i]);
-
-        for (auto* c : visible_chunks) {
-            c->draw(GL_TRIANGLES, shadow_shader, chunkLoc);
+        collect_shadow_casters(shadow_matrices[i], shadow_casters);
+        int drawn = 0;
+        for (const ShadowCaster& caster : shadow_casters) drawn += std::popcount(caster.mask);
+        shadow_caster_counts[i] = drawn;
+
+        if (shadow_caster_shader) {
+            // Solid cubes: merged quads, no fragment stage. Only the remainder is alpha-tested.
+            shadow_caster_shader->use();
+            if (casterLightSpaceLoc >= 0) shadow_caster_shader->setMat4(casterLightSpaceLoc, shadow_matrices[i]);
+            for (const ShadowCaster& caster : shadow_casters) {
+                caster.chunk->draw_casters(caster.mask, shadow_caster_shader, casterChunkLoc);
+            }
+            shadow_shader->use();
+            if (lightSpaceLoc >= 0) shadow_shader->setMat4(lightSpaceLoc, shadow_matrices[i]);
+            for (const ShadowCaster& caster : shadow_casters) {
+                caster.chunk->draw_cutouts(caster.mask, GL_TRIANGLES, shadow_shader, chunkLoc);
+            }
+        } else {
+            shadow_shader->use();
+            if (lightSpaceLoc >= 0) shadow_shader->setMat4(lightSpaceLoc, shadow_matrices[i]);
+            for (const ShadowCaster& caster : shadow_casters) {
+                caster.chunk->draw_subchunks(caster.mask, GL_TRIANGLES, shadow_shader, chunkLoc);
+            }
         }
     }
 
+    GLState::disable(GL_DEPTH_CLAMP);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glDrawBuffer(prevDrawBuffer);
     glReadBuffer(prevReadBuffer);
@@ -627,47 +991,86 @@ void World::draw() {
 #endif
     float dm = get_daylight_factor();
     glClearColor(0.5f * (dm-0.26f), 0.8f*(dm-0.26f), (dm-0.26f)*1.36f, 1.0f);
-    if (shader && shader->valid()) {
+    if (shadows_enabled && shadow_map && shadow_cascade_count > 0) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    upload_frame_uniforms();
+    if (shader && shader->valid()) shader->use();
+
+    GLState::enable(GL_CULL_FACE);
+    // With the pre-pass every covered pixel already has its final depth, so the
+    // expensive shader runs at most once per pixel.
+    bool prepass = Options::DEPTH_PREPASS && draw_depth_prepass();
+    if (prepass) {
         shader->use();
-        shader->setFloat(shader_daylight_loc, dm);
-        // Гарантируем, что сэмплер текстур мира всегда указывает на GL_TEXTURE0
-        int texLoc = shader->find_uniform("u_TextureArraySampler");
-        if (texLoc >= 0) shader->setInt(texLoc, 0);
-
-        if (shadows_enabled && shadow_map && shadow_cascade_count > 0) {
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_map);
-
-            if (shader_shadow_map_loc >= 0) shader->setInt(shader_shadow_map_loc, 1);
-            if (shader_light_space_mats_loc >= 0) shader->setMat4Array(shader_light_space_mats_loc, shadow_matrices);
-            if (shader_cascade_splits_loc >= 0) shader->setFloatArray(shader_cascade_splits_loc, shadow_splits);
-            if (shader_cascade_count_loc >= 0) shader->setInt(shader_cascade_count_loc, shadow_cascade_count);
-            if (shader_shadow_texel_size_loc >= 0 && shadow_map_resolution > 0) {
-                glm::vec2 texelSize(1.0f / static_cast<float>(shadow_map_resolution),
-                                    1.0f / static_cast<float>(shadow_map_resolution));
-                shader->setVec2(shader_shadow_texel_size_loc, texelSize);
-            }
-            if (shader_shadow_min_bias_loc >= 0) shader->setFloat(shader_shadow_min_bias_loc, Options::SHADOW_MIN_BIAS);
-            if (shader_shadow_slope_bias_loc >= 0) shader->setFloat(shader_shadow_slope_bias_loc, Options::SHADOW_SLOPE_BIAS);
-            if (shader_shadow_pcf_radius_loc >= 0) shader->setInt(shader_shadow_pcf_radius_loc, Options::SHADOW_PCF_RADIUS);
-        } else if (shader_cascade_count_loc >= 0) {
-            // Explicitly disable shadows in shader if resources are missing
-            shader->setInt(shader_cascade_count_loc, 0);
-        }
+        GLState::depth_func(GL_EQUAL);
+        GLState::depth_mask(false);
     }
-
-    glEnable(GL_CULL_FACE);
+    // Front to back, so early depth rejection skips most of the overdraw.
     for(auto* c : visible_chunks) c->draw(GL_TRIANGLES);
+    if (prepass) {
+        GLState::depth_func(GL_LESS);
+        GLState::depth_mask(true);
+    }
     draw_translucent();
 }
+
+bool World::draw_depth_prepass() {
+#ifdef UNIT_TEST
+    return false;
+#endif
+    if (!depth_prepass_shader || !depth_prepass_cutout_shader || !player) return false;
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    depth_prepass_shader->use();
+    int chunkLoc = depth_prepass_shader->find_uniform("u_ChunkPosition");
+    for (auto* c : visible_chunks) c->draw_solids(~0u, GL_TRIANGLES, depth_prepass_shader, chunkLoc);
+
+    depth_prepass_cutout_shader->use();
+    int samplerLoc = depth_prepass_cutout_shader->find_uniform("u_TextureArraySampler");
+    if (samplerLoc >= 0) depth_prepass_cutout_shader->setInt(samplerLoc, 0);
+    chunkLoc = depth_prepass_cutout_shader->find_uniform("u_ChunkPosition");
+    for (auto* c : visible_chunks) c->draw_cutouts(~0u, GL_TRIANGLES, depth_prepass_cutout_shader, chunkLoc);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    return true;
+}
+void World::upload_frame_uniforms() {
+#ifdef UNIT_TEST
+    return;
+#endif
+    FrameUniforms& u = frame_uniforms;
+    if (player) {
+        u.mvp = player->vp_matrix;
+        u.view = player->mv_matrix;
+    }
+    u.daylight = get_daylight_factor();
+    u.cascade_count = 0;
+    if (shadows_enabled && shadow_map && shadow_cascade_count > 0) {
+        u.cascade_count = std::min(shadow_cascade_count, 4);
+        for (int i = 0; i < u.cascade_count; i++) {
+            u.light_space[i] = shadow_matrices[i];
+            u.cascade_splits[i] = shadow_splits[i];
+        }
+        u.shadow_texel_size = glm::vec2(1.0f / static_cast<float>(shadow_map_resolution));
+        u.shadow_min_bias = Options::SHADOW_MIN_BIAS;
+        u.shadow_slope_bias = Options::SHADOW_SLOPE_BIAS;
+        u.pcf_radius = Options::SHADOW_PCF_RADIUS;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, frame_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &u);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
 void World::draw_translucent() {
 #ifdef UNIT_TEST
     return;
 #endif
-    glDepthMask(GL_FALSE);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    for(auto* c : visible_chunks) c->draw_translucent(GL_TRIANGLES);
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
+    GLState::depth_mask(false);
+    GLState::enable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    // Back to front for blending.
+    for (auto it = visible_chunks.rbegin(); it != visible_chunks.rend(); ++it) (*it)->draw_translucent(GL_TRIANGLES);
+    GLState::disable(GL_BLEND);
+    GLState::depth_mask(true);
 }
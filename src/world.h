@@ -1,46 +1,119 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
+#include <span>
 #include <glm/glm.hpp>
 #include "chunk/chunk.h"
+#include "chunk/mesh_cache.h"
+#include "chunk/mesh_buffer_pool.h"
+#include "chunk/vertex_buffer_pool.h"
+#include "chunk/chunk_pool.h"
+#include "chunk/compressed_chunk_cache.h"
+#include "chunk/remesh_scheduler.h"
+#include "chunk/translucent_sorter.h"
 #include "entity/player.h"
 #include "renderer/shader.h"
 #include "renderer/texture_manager.h"
+#include "renderer/block_properties.h"
 #include "options.h"
 #include "save.h"
 #include "util.h"
 #include "physics/collider.h"
 
+struct BlockEdit {
+    glm::ivec3 pos;
+    int number;
+};
+
 class World {
 public:
     Shader* shader;
     Player* player;
     TextureManager* texture_manager;
     std::vector<BlockType*> block_types;
+    BlockProperties block_properties;
     std::unordered_map<glm::ivec3, Chunk*, Util::IVec3Hash> chunks;
+    // Nearest first: the opaque pass walks it forwards, the translucent pass backwards.
     std::vector<Chunk*> visible_chunks;
+    std::vector<float> visible_distances; // squared distance to the eye, parallel to visible_chunks
+    glm::ivec3 render_order_chunk{0};     // eye chunk at the last full sort
+    int render_order_full_sorts = 0;
+
+    // Per-chunk back-to-front translucent orders, sorted off the main thread.
+    // A chunk is re-sorted when its quads change or the eye has moved
+    // TRANSLUCENT_RESORT_DISTANCE plus TRANSLUCENT_RESORT_SLOPE * its distance.
+    static constexpr float TRANSLUCENT_RESORT_DISTANCE = 1.0f;
+    static constexpr float TRANSLUCENT_RESORT_SLOPE = 0.05f;
+    TranslucentSorter translucent_sorter;
+    uint32_t next_translucent_generation = 1;
 
     std::deque<std::pair<glm::ivec3, int>> light_increase_queue;
     std::deque<std::pair<glm::ivec3, int>> light_decrease_queue;
     std::deque<std::pair<glm::ivec3, int>> skylight_increase_queue;
     std::deque<std::pair<glm::ivec3, int>> skylight_decrease_queue;
     std::deque<Chunk*> chunk_building_queue;
-
+    // Intrusive list (Chunk::dirty_prev/next) of chunks with subchunks waiting for a rebuild.
+    Chunk* dirty_chunks_head = nullptr;
+    Chunk* dirty_chunks_tail = nullptr;
+    // While a player edit runs, every subchunk it dirties is recorded here.
+    std::vector<std::pair<Chunk*, int>>* edit_capture = nullptr;
+
+    struct BatchedEdit {
+        glm::ivec3 pos;
+        uint8_t old_light; // light before the batch touched this voxel
+        uint8_t old_sky;
+    };
+    int batch_depth = 0;
+    std::vector<BatchedEdit> batch_edits;
+    std::unordered_set<glm::ivec3, Util::IVec3Hash> batch_positions;
+    MeshCache mesh_cache;
+    MeshBufferPool mesh_pool;
+    VertexBufferPool vbo_pool;
+    ChunkPool chunk_pool{this};
+    CompressedChunkCache compressed_chunks;
+    RemeshScheduler remesh_scheduler{this};
+
+    // Block ids that emit light; baked into block_properties.light_emission.
     std::unordered_set<int> light_blocks = {10, 11, 50, 51, 62, 75};
 
     float daylight = 1800;
     int incrementer = 0;
     long time = 0;
     int chunk_update_counter = 0;
+    int mesh_rebuilds_skipped = 0; // queued rebuilds whose inputs were unchanged
+    int mesh_relayouts = 0;        // uploads that outgrew a slot and re-laid out the chunk VBO
     int pending_chunk_update_count = 0;
     GLuint ibo = 0;
-    int shader_daylight_loc = -1;
+
+    // std140 mirror of the FrameUniforms block in the world shaders; uploaded once per
+    // frame and bound at Shader::FRAME_UNIFORMS_BINDING for every program that declares it.
+    struct FrameUniforms {
+        glm::mat4 mvp;
+        glm::mat4 view;
+        glm::mat4 light_space[4];
+        glm::vec4 cascade_splits{0.0f};
+        glm::vec2 shadow_texel_size{0.0f};
+        float daylight = 1.0f;
+        float shadow_min_bias = 0.0f;
+        float shadow_slope_bias = 0.0f;
+        int32_t cascade_count = 0;
+        int32_t pcf_radius = 0;
+        int32_t padding = 0;
+    };
+    GLuint frame_ubo = 0;
+    FrameUniforms frame_uniforms;
 
     // Shadow mapping resources
-    Shader* shadow_shader = nullptr;
+    Shader* shadow_shader = nullptr;        // alpha-tested, full vertex format
+    Shader* shadow_caster_shader = nullptr; // vertex-only, position-only caster stream
+    // Depth pre-pass (Options::DEPTH_PREPASS): solid faces through a vertex-only program,
+    // alpha-tested faces through the shadow alpha-test fragment shader.
+    Shader* depth_prepass_shader = nullptr;
+    Shader* depth_prepass_cutout_shader = nullptr;
     GLuint shadow_fbo = 0;
     GLuint shadow_map = 0;
     int shadow_map_resolution = 0;
@@ -50,27 +123,65 @@ public:
     std::vector<glm::mat4> shadow_matrices;
     std::vector<float> shadow_splits;
 
-    // Cached uniform locations in the main world shader
-    int shader_shadow_map_loc = -1;
-    int shader_light_space_mats_loc = -1;
-    int shader_cascade_splits_loc = -1;
-    int shader_cascade_count_loc = -1;
-    int shader_shadow_texel_size_loc = -1;
-    int shader_shadow_min_bias_loc = -1;
-    int shader_shadow_slope_bias_loc = -1;
-    int shader_shadow_pcf_radius_loc = -1;
+    // Per-cascade caster list: chunks and the subchunks of each that can cast into the cascade.
+    struct ShadowCaster { Chunk* chunk; uint32_t mask; };
+    std::vector<ShadowCaster> shadow_casters;
+    std::vector<int> shadow_caster_counts; // subchunks drawn per cascade when last rendered
+
+    // Cached cascade maps: layer i was rendered with shadow_matrices[i] and is kept until the
+    // fit moves past the margin, the sun steps, or geometry inside the cascade is re-uploaded.
+    struct ShadowCascade {
+        glm::vec3 center{0.0f};
+        float radius = 0.0f;
+        glm::vec3 light_dir{0.0f};
+        glm::mat4 target{1.0f}; // latest fit, applied when the cascade is next rendered
+        bool refit = true;
+        bool dirty = true;
+        bool rendered = false;
+    };
+    std::vector<ShadowCascade> shadow_cascades;
+    long shadow_frame = 0;
+    int shadow_cascades_rendered = 0; // last frame
 
     Save* save_system = nullptr;
 
     World(Shader* s, TextureManager* tm, Player* p);
     ~World();
 
+    // Must be called once block_types is populated (after load_blocks).
+    void build_block_properties();
+
+    // Vertex data held on the CPU (staged subchunk meshes plus the buffer pool) and in chunk VBOs.
+    // Shadow caster streams stay resident on the CPU and are counted apart.
+    struct MeshMemory { size_t cpu_bytes = 0; size_t pool_bytes = 0; size_t gpu_bytes = 0; size_t caster_bytes = 0; };
+    MeshMemory mesh_memory() const;
+
+    void link_dirty_chunk(Chunk* c);
+    void unlink_dirty_chunk(Chunk* c);
+
     void tick(float dt);
     void draw();
     void draw_translucent();
+    // Fills the depth buffer with the visible opaque geometry; returns false if it did not run.
+    bool draw_depth_prepass();
+    void upload_frame_uniforms();
 
     void set_block(glm::ivec3 pos, int number);
     bool try_set_block(glm::ivec3 pos, int number, const Collider& player_collider);
+    // set_block for player edits: relights and remeshes the touched sections
+    // synchronously, ahead of the background lighting and remesh backlog.
+    void apply_player_edit(glm::ivec3 pos, int number);
+    // Exchanges the four light queues with `parked` (block increase, block decrease,
+    // sky increase, sky decrease). Synchronous relights park the background backlog
+    // so they only pay for their own light.
+    void swap_light_queues(std::deque<std::pair<glm::ivec3, int>> (&parked)[4]);
+
+    // Bulk edits: between begin_batch() and commit(), set_block only writes
+    // blocks. commit() runs one combined relight (all decreases, then all
+    // increases) and marks each touched section dirty once. Batches nest.
+    void begin_batch();
+    void set_blocks(std::span<const BlockEdit> edits);
+    void commit();
 
     int get_block_number(glm::ivec3 pos);
     int get_light(glm::ivec3 pos);
@@ -80,6 +191,7 @@ public:
     void decrease_skylight(glm::ivec3 pos);
 
     void init_skylight(Chunk* chunk);
+    void mark_neighbour_chunks_dirty(glm::ivec3 chunk_pos, glm::ivec3 local_pos);
 
     bool is_opaque_block(glm::ivec3 pos);
     bool get_transparency(glm::ivec3 pos);
@@ -95,12 +207,32 @@ public:
     void stitch_sky_light(class Chunk* c);
 
     void prepare_rendering();
+    // Re-sorts visible_chunks fully when the eye enters another chunk or chunks were
+    // added; otherwise refreshes the distances and fixes the order by insertion sort.
+    void update_render_order(const glm::vec3& eye);
+    void remove_visible_chunk(Chunk* chunk);
+    // Uploads finished translucent orders and queues the chunks that need a new one.
+    void update_translucent_order(const glm::vec3& eye);
     void render_shadows();
 
     bool init_shadow_resources();
     void update_shadow_cascades();
+    // Culls visible_chunks against a cascade's light-space box, extended toward the light:
+    // only the far side is tested in depth, the shadow pass clamps nearer casters.
+    void collect_shadow_casters(const glm::mat4& light_space, std::vector<ShadowCaster>& out) const;
+    // Marks the cached cascades that can see the chunk for re-rendering (after an upload or unload).
+    void note_shadow_caster_change(const Chunk* c);
 
     void speed_daytime();
+    // Sun direction, advanced in steps of Options::SHADOW_SUN_STEP_TICKS so cached shadows stay valid.
     glm::vec3 get_light_direction() const;
     float get_daylight_factor() const;
 };
+
+// std140 offsets of the FrameUniforms block members.
+static_assert(offsetof(World::FrameUniforms, light_space) == 128);
+static_assert(offsetof(World::FrameUniforms, cascade_splits) == 384);
+static_assert(offsetof(World::FrameUniforms, shadow_texel_size) == 400);
+static_assert(offsetof(World::FrameUniforms, daylight) == 408);
+static_assert(offsetof(World::FrameUniforms, cascade_count) == 420);
+static_assert(sizeof(World::FrameUniforms) == 432);
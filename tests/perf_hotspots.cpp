@@ -1,12 +1,14 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
 #include <vector>
 
 #include "../src/world.h"
 #include "../src/physics/collider.h"
+#include "../src/models/all_models.h"
 
 using Clock = std::chrono::high_resolution_clock;
 
@@ -16,10 +18,9 @@ static BlockType* make_block_type(bool transparent, bool translucent = false) {
     bt->glass = false;
     bt->translucent = translucent;
     bt->is_cube = true;
-    bt->vertex_positions = std::vector<std::vector<float>>(6, std::vector<float>(12, 0.0f));
-    bt->tex_coords = std::vector<std::vector<float>>(6, std::vector<float>(8, 0.0f));
+    bt->model = Models::Cube::get_model();
     bt->tex_indices = std::vector<int>(6, 0);
-    bt->shading_values = std::vector<std::vector<float>>(6, std::vector<float>(4, 1.0f));
+    bt->bake_faces();
     return bt;
 }
 
@@ -28,6 +29,13 @@ static std::unique_ptr<World> build_world_for_bench() {
     world->block_types.resize(76);
     world->block_types[1] = make_block_type(false); // обычный блок
     world->block_types[10] = make_block_type(false); // источник света
+    auto* plant = make_block_type(true);
+    plant->is_cube = false;
+    plant->model = Models::Plant::get_model();
+    plant->tex_indices = std::vector<int>(plant->model.vertex_positions.size(), 0);
+    plant->bake_faces();
+    world->block_types[20] = plant;
+    world->build_block_properties();
     return world;
 }
 
@@ -50,6 +58,30 @@ double bench_set_block(int block_id, int iterations) {
     return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
+// Fill then clear a 16x16x2 slab: one set_block per voxel vs. two batches.
+double bench_fill_region(bool batched) {
+    auto world = build_world_for_bench();
+    world->set_block({0, 0, 0}, 1);
+    std::vector<BlockEdit> place, clear;
+    for (int x = 0; x < 16; x++)
+        for (int z = 0; z < 16; z++)
+            for (int y = 60; y < 62; y++) {
+                place.push_back({{x, y, z}, 1});
+                clear.push_back({{x, y, z}, 0});
+            }
+
+    auto start = Clock::now();
+    if (batched) {
+        world->set_blocks(place);
+        world->set_blocks(clear);
+    } else {
+        for (const auto& e : place) world->set_block(e.pos, e.number);
+        for (const auto& e : clear) world->set_block(e.pos, e.number);
+    }
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
 static void fill_chunk(Chunk* chunk, int block_id, bool sparse) {
     for (int x = 0; x < CHUNK_WIDTH; x++) {
         for (int z = 0; z < CHUNK_LENGTH; z++) {
@@ -67,8 +99,9 @@ double bench_chunk_meshing(bool sparse, int iterations) {
     fill_chunk(&chunk, 1, sparse);
 
     auto rebuild_subchunks = [&]() {
-        for (auto& kv : chunk.subchunks) {
-            kv.second->update_mesh();
+        for (auto& sc : chunk.subchunks) {
+            sc.has_mesh = false; // force a real rebuild past the input-hash check
+            sc.update_mesh();
         }
     };
 
@@ -84,6 +117,130 @@ double bench_chunk_meshing(bool sparse, int iterations) {
     return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
 }
 
+// Mixed content: cube terrain with plants on every fourth column, so the
+// section never qualifies for the cube-only kernel.
+static void fill_chunk_mixed(Chunk* chunk) {
+    for (int x = 0; x < CHUNK_WIDTH; x++) {
+        for (int z = 0; z < CHUNK_LENGTH; z++) {
+            for (int y = 0; y < CHUNK_HEIGHT; y++) {
+                int id = 0;
+                if (y < 64) id = ((x * 7 + y * 3 + z) % 5 == 0) ? 0 : 1;
+                else if ((x + z) % 4 == 0 && y % 16 == 0) id = 20;
+                chunk->blocks[x][y][z] = id;
+            }
+        }
+    }
+}
+
+double bench_mesh_variant(bool mixed, bool smooth, bool fancy, int iterations, const char** kernel) {
+    auto world = build_world_for_bench();
+    Chunk chunk(world.get(), {0, 0, 0});
+    if (mixed) fill_chunk_mixed(&chunk);
+    else fill_chunk(&chunk, 1, false);
+
+    bool cube_only = true;
+    for (auto& sc : chunk.subchunks) cube_only = cube_only && sc.is_cube_only();
+    *kernel = Subchunk::kernel_name(smooth, fancy, cube_only);
+    for (auto& sc : chunk.subchunks) sc.update_mesh(smooth, fancy);
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (auto& sc : chunk.subchunks) {
+            sc.has_mesh = false;
+            sc.update_mesh(smooth, fancy);
+        }
+    }
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Cost of a queued rebuild whose inputs did not change (hash only).
+double bench_unchanged_remesh(int iterations) {
+    auto world = build_world_for_bench();
+    Chunk chunk(world.get(), {0, 0, 0});
+    fill_chunk(&chunk, 1, false);
+    for (auto& sc : chunk.subchunks) sc.update_mesh();
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (auto& sc : chunk.subchunks) sc.update_mesh();
+    }
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Steady-state CPU vertex memory for a meshed 4x4 region, against what the
+// old scheme kept (every subchunk mesh plus a padded per-chunk copy).
+static void bench_mesh_memory(size_t* cpu_bytes, size_t* retained_before) {
+    auto world = build_world_for_bench();
+    for (int x = 0; x < 4; x++) {
+        for (int z = 0; z < 4; z++) {
+            Chunk* c = new Chunk(world.get(), {x, 0, z});
+            world->chunks[{x, 0, z}] = c;
+            fill_chunk_mixed(c);
+            c->update_subchunk_meshes();
+        }
+    }
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+
+    *retained_before = 0;
+    for (const auto& kv : world->chunks) {
+        const Chunk* c = kv.second;
+        size_t ints = static_cast<size_t>(c->mesh_quad_count + c->translucent_quad_count) * 12;
+        for (int i = 0; i < SUBCHUNK_COUNT; i++) ints += c->opaque_slots[i].used + c->translucent_slots[i].used;
+        *retained_before += ints * sizeof(uint32_t);
+    }
+    *cpu_bytes = world->mesh_memory().cpu_bytes;
+}
+
+// Vertex data the shadow pass reads per chunk: the full opaque mesh before,
+// merged casters plus the alpha-tested remainder now.
+static void bench_shadow_casters(bool mixed, size_t* full_bytes, size_t* caster_bytes) {
+    auto world = build_world_for_bench();
+    Chunk chunk(world.get(), {0, 0, 0});
+    if (mixed) {
+        fill_chunk_mixed(&chunk);
+    } else {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+            for (int z = 0; z < CHUNK_LENGTH; z++)
+                for (int y = 0; y < 40 + (x / 4 + z / 4) % 3; y++) chunk.blocks[x][y][z] = 1;
+    }
+    *full_bytes = *caster_bytes = 0;
+    for (auto& sc : chunk.subchunks) {
+        sc.update_mesh();
+        *full_bytes += sc.mesh.size() * sizeof(uint32_t);
+        *caster_bytes += (sc.caster_mesh.size() + sc.mesh.size() - sc.cutout_start) * sizeof(uint32_t);
+    }
+}
+
+// Depth pre-pass split per chunk: quads drawn by the vertex-only program
+// against those that still need the alpha-tested one.
+static void bench_depth_prepass(size_t* solid_quads, size_t* cutout_quads) {
+    auto world = build_world_for_bench();
+    Chunk chunk(world.get(), {0, 0, 0});
+    fill_chunk_mixed(&chunk);
+    *solid_quads = *cutout_quads = 0;
+    for (auto& sc : chunk.subchunks) {
+        sc.update_mesh();
+        *solid_quads += sc.cutout_start / 12;
+        *cutout_quads += (sc.mesh.size() - sc.cutout_start) / 12;
+    }
+}
+
+// Back-to-front radix sort of one water surface's worth of translucent quads.
+static double bench_translucent_sort(int quads, int iterations) {
+    std::mt19937 rng(3);
+    std::vector<TranslucentQuad> surface;
+    for (int i = 0; i < quads; i++) {
+        surface.push_back({static_cast<int16_t>(rng() % 1024), static_cast<int16_t>(rng() % 8192),
+                           static_cast<int16_t>(rng() % 1024), static_cast<uint32_t>(i)});
+    }
+    std::vector<uint32_t> order;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) sort_back_to_front(surface, {8.0f, 64.0f + i % 8, 8.0f}, order);
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+}
+
 int main() {
     const int set_iters = 500;
     double opaque_ms = bench_set_block(1, set_iters);
@@ -91,10 +248,41 @@ int main() {
 
     std::cout << "[set_block] " << set_iters << " opaque place/remove: " << opaque_ms << " ms total\n";
     std::cout << "[set_block] " << set_iters << " light place/remove:  " << light_ms << " ms total\n";
+    std::cout << "[set_block] 512 fill+clear, one by one: " << bench_fill_region(false) << " ms total\n";
+    std::cout << "[set_blocks] 512 fill+clear, batched:   " << bench_fill_region(true) << " ms total\n";
 
     double dense_mesh = bench_chunk_meshing(false, 10);
     double sparse_mesh = bench_chunk_meshing(true, 10);
     std::cout << "[meshing] dense chunk avg:  " << dense_mesh << " ms per rebuild\n";
     std::cout << "[meshing] sparse chunk avg: " << sparse_mesh << " ms per rebuild\n";
+    std::cout << "[meshing] unchanged chunk:  " << bench_unchanged_remesh(10) << " ms per skipped rebuild\n";
+
+    size_t cpu_bytes = 0, retained_before = 0;
+    bench_mesh_memory(&cpu_bytes, &retained_before);
+    std::cout << "[mesh memory] 16 chunks: " << cpu_bytes / 1024 << " KB CPU after upload (pool only), "
+              << retained_before / 1024 << " KB with retained copies\n";
+
+    for (int mixed = 0; mixed < 2; mixed++) {
+        size_t full_bytes = 0, caster_bytes = 0;
+        bench_shadow_casters(mixed, &full_bytes, &caster_bytes);
+        std::cout << "[shadow casters] " << (mixed ? "mixed" : "terrain") << " chunk: " << caster_bytes
+                  << " B depth stream vs " << full_bytes << " B full opaque mesh\n";
+    }
+
+    std::cout << "[translucent sort] 4096 quads: " << bench_translucent_sort(4096, 100) << " ms per sort\n";
+
+    size_t solid_quads = 0, cutout_quads = 0;
+    bench_depth_prepass(&solid_quads, &cutout_quads);
+    std::cout << "[depth pre-pass] mixed chunk: " << solid_quads << " depth-only quads, "
+              << cutout_quads << " alpha-tested\n";
+
+    for (int mixed = 0; mixed < 2; mixed++) {
+        for (int variant = 0; variant < 4; variant++) {
+            bool smooth = variant & 2, fancy = variant & 1;
+            const char* kernel = "";
+            double ms = bench_mesh_variant(mixed, smooth, fancy, 10, &kernel);
+            std::cout << "[mesh variant] " << (mixed ? "mixed " : "dense ") << kernel << ": " << ms << " ms per chunk\n";
+        }
+    }
     return 0;
 }
@@ -2,11 +2,18 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <functional>
+#include <filesystem>
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include "../src/world.h"
 #include "../src/physics/collider.h"
+#include "../src/models/all_models.h"
 #include "../src/physics/hit.h"
+#include "../src/renderer/dynamic_resolution.h"
+#include "../src/renderer/gl_state.h"
 
 struct TestRunner {
     int passed = 0;
@@ -32,10 +39,9 @@ static BlockType* make_block_type(bool transparent, bool glass = false, bool tra
     bt->glass = glass;
     bt->translucent = translucent;
     bt->is_cube = true;
-    bt->vertex_positions = std::vector<std::vector<float>>(6, std::vector<float>(12, 0.0f));
-    bt->tex_coords = std::vector<std::vector<float>>(6, std::vector<float>(8, 0.0f));
+    bt->model = Models::Cube::get_model();
     bt->tex_indices = std::vector<int>(6, 0);
-    bt->shading_values = std::vector<std::vector<float>>(6, std::vector<float>(4, 1.0f));
+    bt->bake_faces();
     return bt;
 }
 
@@ -52,6 +58,7 @@ static std::unique_ptr<World> build_test_world() {
     world->block_types[2] = make_solid_block_with_collider();   // Ground block
     world->block_types[3] = make_solid_block_with_collider();   // Grass block
     world->block_types[10] = make_block_type(false);            // Light source
+    world->build_block_properties();
     return world;
 }
 
@@ -59,6 +66,636 @@ static bool ivec_equal(glm::ivec3 a, glm::ivec3 b) {
     return a.x == b.x && a.y == b.y && a.z == b.z;
 }
 
+static void test_block_property_table(TestRunner& tr) {
+    auto world = build_test_world();
+    world->block_types.resize(21);
+    world->block_types[20] = make_block_type(true, true, true); // Water-like
+    world->build_block_properties();
+    const BlockProperties& props = world->block_properties;
+
+    tr.check(!props.is_opaque(0) && props.is_transparent(0), "props_air", "Air should be transparent and not opaque");
+    tr.check(props.is_opaque(1) && props.is_cube(1), "props_solid", "Solid cube should be flagged opaque and cube");
+    tr.check(props.collider_class(1) == ColliderClass::Full, "props_full_collider", "Unit collider should classify as full");
+    tr.check(props.emission(10) == 15 && props.emission(1) == 0, "props_light_emission", "Only light blocks should emit light");
+    tr.check(props.is_glass(20) && props.is_translucent(20) && props.opacity(20) == 0,
+             "props_glass_translucent", "Glass-like blocks should not attenuate skylight");
+    tr.check(!props.is_opaque(5) && props.collider_class(5) == ColliderClass::None,
+             "props_unknown_id", "Unregistered ids should behave like air");
+}
+
+static void test_face_templates_baked(TestRunner& tr) {
+    ModelData md = Models::Slab::get_model();
+    BlockType slab(nullptr, "slab", {}, md);
+
+    tr.check(slab.faces.size() == 6, "face_templates_count", "Slab should bake one template per model face");
+    const FaceTemplate& top = slab.faces[2];
+    tr.check(top.position[0] == 8 && top.position[1] == 0 && top.position[2] == 8,
+             "face_template_positions", "Positions should be packed in 1/16 block units");
+    tr.check(slab.faces[0].uv[1] == 128 && top.shading[0] == 255,
+             "face_template_uv_shading", "UVs and shading should be packed to bytes");
+}
+
+static void test_mesher_variants(TestRunner& tr) {
+    auto world = build_test_world();
+    world->block_types.resize(21);
+    world->block_types[20] = make_block_type(true, true, true); // Water-like
+    world->build_block_properties();
+    Chunk chunk(world.get(), {0, 0, 0});
+    chunk.blocks[1][1][1] = 1;
+    chunk.blocks[3][1][1] = 20;
+    Subchunk* sc = &chunk.subchunks[0];
+
+    tr.check(sc->is_cube_only(), "mesher_cube_only", "Section of full cubes should select the cube-only kernel");
+    sc->update_mesh(true, true);
+    tr.check(sc->mesh.size() == 6 * 12 && sc->translucent_mesh.size() == 6 * 12,
+             "mesher_fancy_split", "Fancy translucency should keep translucent faces separate");
+    sc->update_mesh(false, false);
+    tr.check(sc->mesh.size() == 12 * 12 && sc->translucent_mesh.empty(),
+             "mesher_single_pass", "Without fancy translucency all faces go to the opaque mesh");
+}
+
+static void test_mesh_input_hash(TestRunner& tr) {
+    auto world = build_test_world();
+    world->mesh_cache.set_capacity(16);
+    world->set_block({1, 1, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    Subchunk* sc = &chunk->subchunk_at(0, 0, 0);
+    Subchunk* above = &chunk->subchunk_at(0, 1, 0);
+
+    tr.check(sc->update_mesh() && !sc->update_mesh(), "mesh_hash_skip", "Unchanged inputs should not rebuild the mesh");
+    above->update_mesh();
+    world->set_block({1, 15, 1}, 1);
+    tr.check(sc->update_mesh() && above->update_mesh(), "mesh_hash_border",
+             "A change on the shared border should invalidate both sections");
+
+    std::vector<uint32_t> old_mesh = sc->mesh;
+    chunk->evict_meshes_to_cache();
+    tr.check(sc->update_mesh() && sc->mesh == old_mesh && world->mesh_cache.hits == 1,
+             "mesh_cache_reuse", "Evicted meshes should be reused when the inputs match");
+}
+
+static void test_border_faces_wait_for_neighbours(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({15, 1, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    for (auto& sub : chunk->subchunks) sub.update_mesh();
+    Subchunk* sc = &chunk->subchunk_at(0, 0, 0);
+
+    tr.check((sc->missing_mask & 1) && sc->mesh.size() == 5 * 12, "border_face_skipped",
+             "Faces towards an unloaded chunk should be left out");
+    tr.check(sc->border_mask == 1 && chunk->subchunk_at(0, 1, 0).border_mask == 0,
+             "border_mask_recorded", "Only sections with edge blocks depend on the neighbour");
+
+    world->set_block({20, 1, 1}, 1); // loads the east neighbour, edge stays air
+    chunk->dirty_mask = 0;
+    chunk->update_border_subchunks(0);
+    tr.check(chunk->dirty_mask == (1u << sc->index()),
+             "border_requeue_only_edge", "Only the section touching the new neighbour should be requeued");
+    tr.check(sc->update_mesh() && sc->mesh.size() == 6 * 12 && sc->missing_mask == 0,
+             "border_face_emitted", "Skipped faces should appear once the neighbour is loaded");
+}
+
+static void test_cached_mesh_keeps_border_state(TestRunner& tr) {
+    auto world = build_test_world();
+    world->mesh_cache.set_capacity(16);
+    world->set_block({15, 1, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    Subchunk* sc = &chunk->subchunk_at(0, 0, 0);
+    sc->update_mesh();
+    chunk->evict_meshes_to_cache();
+    sc->init(chunk, sc->subchunk_position); // as when the chunk is reloaded into a pooled slot
+
+    tr.check(sc->update_mesh() && world->mesh_cache.hits == 1 && (sc->missing_mask & 1) && sc->border_mask == 1,
+             "mesh_cache_border_state", "A cached mesh should come back with its edge masks");
+
+    world->set_block({20, 1, 1}, 1); // loads the east neighbour
+    chunk->dirty_mask = 0;
+    chunk->update_border_subchunks(0);
+    tr.check(chunk->dirty_mask & (1u << sc->index()), "mesh_cache_border_requeue",
+             "A cached section with holes should be requeued when the neighbour loads");
+}
+
+static void test_remesh_scheduler_priority(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({80, 1, 1}, 1);  // far chunk
+    world->set_block({1, 1, 1}, 1);   // near chunk
+    Chunk* far_chunk = world->chunks[{5, 0, 0}];
+    Chunk* near_chunk = world->chunks[{0, 0, 0}];
+    far_chunk->last_edit_time = near_chunk->last_edit_time = -1;
+    world->time = 1000;
+
+    world->remesh_scheduler.run(0);
+    tr.check(world->remesh_scheduler.rebuilt_last_run == 1 && !(near_chunk->dirty_mask & 1) && (far_chunk->dirty_mask & 1),
+             "scheduler_nearest_first", "Zero budget should still rebuild exactly the nearest dirty section");
+
+    far_chunk->last_edit_time = world->time;
+    world->remesh_scheduler.run(0);
+    tr.check(!(far_chunk->dirty_mask & 1), "scheduler_edit_first", "Recently edited chunks should jump the queue");
+
+    world->remesh_scheduler.run(1000000);
+    tr.check(!world->dirty_chunks_head && world->chunk_building_queue.empty(),
+             "scheduler_drains_with_budget", "A large budget should rebuild and upload all pending work");
+}
+
+static void test_player_edit_fast_lane(TestRunner& tr) {
+    auto world = build_test_world();
+    Collider far_player(glm::vec3(100), glm::vec3(101));
+    world->set_block({1, 1, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    world->remesh_scheduler.run(1000000);
+    auto slots = chunk->opaque_slots;
+
+    int relayouts = world->mesh_relayouts;
+
+    world->try_set_block({3, 1, 1}, 1, far_player);
+    const Subchunk& sc = chunk->subchunks[0];
+    tr.check(!(chunk->dirty_mask & 1) && !sc.staged && chunk->opaque_slots[0].used == 12 * 12, "fast_lane_remeshed",
+             "Player edits should remesh and upload the touched section synchronously");
+    tr.check(chunk->opaque_slots[0].offset == slots[0].offset && world->mesh_relayouts == relayouts,
+             "fast_lane_range_upload", "A small edit should be written in place into the section's slot");
+    tr.check(sc.mesh.capacity() == 0 && sc.translucent_mesh.capacity() == 0, "fast_lane_releases_mesh",
+             "Uploaded sections should hand their CPU buffers back to the pool");
+}
+
+static void test_fast_lane_takes_staged_sections(TestRunner& tr) {
+    auto world = build_test_world();
+    Collider far_player(glm::vec3(100), glm::vec3(101));
+    world->set_block({1, 1, 1}, 1);
+    world->set_block({1, 17, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+
+    world->set_block({3, 17, 1}, 1);
+    world->set_block({3, 1, 1}, 1);
+    chunk->rebuild_subchunk(1); // the scheduler gets to the upper section first
+    tr.check(chunk->subchunks[1].staged && (chunk->dirty_mask & 1), "fast_lane_staged_setup",
+             "The rebuilt section should wait for the rest of the chunk");
+
+    world->try_set_block({5, 1, 1}, 1, far_player);
+    tr.check(!chunk->dirty_mask && !chunk->subchunks[0].staged && !chunk->subchunks[1].staged &&
+             chunk->opaque_slots[0].used == 3 * 6 * 12 && chunk->opaque_slots[1].used == 2 * 6 * 12,
+             "fast_lane_uploads_staged", "An edit that finishes the chunk should also upload sections rebuilt in the background");
+}
+
+static void test_relayout_keeps_unchanged_sections(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({1, 1, 1}, 1);
+    world->set_block({1, 17, 1}, 1);
+    Chunk* chunk = world->chunks[{0, 0, 0}];
+    chunk->update_subchunk_meshes();
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    auto upper = chunk->opaque_slots[1];
+    int relayouts = world->mesh_relayouts;
+
+    // Enough separate cubes to outgrow the lower section's slot.
+    std::vector<BlockEdit> edits;
+    for (int x = 2; x < 16; x += 2)
+        for (int z = 2; z < 16; z += 2) edits.push_back({{x, 3, z}, 1});
+    world->set_blocks(edits);
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+
+    tr.check(world->mesh_relayouts == relayouts + 1 && chunk->opaque_slots[0].used == 50 * 6 * 12,
+             "relayout_on_overflow", "A section that outgrows its slot should trigger one relayout");
+    tr.check(chunk->opaque_slots[1].used == upper.used && chunk->opaque_slots[1].offset > upper.offset,
+             "relayout_keeps_unchanged", "Unchanged sections should keep their geometry when slots move");
+    World::MeshMemory mem = world->mesh_memory();
+    tr.check(chunk->staged_sections() == 0 && mem.cpu_bytes == mem.pool_bytes, "mesh_cpu_copies_released",
+             "No subchunk should keep CPU geometry once everything is uploaded");
+}
+
+static void test_shadow_caster_culling(TestRunner& tr) {
+    auto world = build_test_world();
+    for (glm::ivec3 pos : {glm::ivec3(1, 1, 1), glm::ivec3(1, 17, 1), glm::ivec3(1, 100, 1), glm::ivec3(50, 17, 1)}) {
+        world->set_block(pos, 1);
+    }
+    Chunk* near_chunk = world->chunks[{0, 0, 0}];
+    Chunk* far_chunk = world->chunks[{3, 0, 0}];
+    near_chunk->update_subchunk_meshes();
+    far_chunk->update_subchunk_meshes();
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    world->visible_chunks = {far_chunk, near_chunk};
+
+    // Sun straight overhead; the cascade box spans x,z 0..16 and y 20..39.9.
+    glm::mat4 light_view = glm::lookAt(glm::vec3(8, 40, 8), glm::vec3(8, 0, 8), glm::vec3(0, 0, -1));
+    glm::mat4 light_space = glm::ortho(-8.0f, 8.0f, -8.0f, 8.0f, 0.1f, 20.0f) * light_view;
+    std::vector<World::ShadowCaster> casters;
+    world->collect_shadow_casters(light_space, casters);
+    tr.check(casters.size() == 1 && casters[0].chunk == near_chunk, "shadow_casters_cull_chunks",
+             "Chunks outside a cascade's light-space box should not cast into it");
+    tr.check(!casters.empty() && casters[0].mask == ((1u << 1) | (1u << 6)), "shadow_casters_toward_light",
+             "Sections beyond the cascade should be culled, sections between it and the light kept");
+}
+
+static void test_shadow_caster_stream(TestRunner& tr) {
+    auto world = build_test_world();
+    world->block_types.resize(12);
+    world->block_types[11] = make_block_type(true); // leaves-like: full cube, see-through
+    world->build_block_properties();
+    std::vector<BlockEdit> floor;
+    for (int x = 0; x < 16; x++)
+        for (int z = 0; z < 16; z++) floor.push_back({{x, 1, z}, 1});
+    floor.push_back({{3, 5, 3}, 11});
+    world->set_blocks(floor);
+    Chunk* c = world->chunks[{0, 0, 0}];
+    c->update_subchunk_meshes();
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    const Subchunk& sc = c->subchunk_at(0, 0, 0);
+
+    // Top and bottom of the floor; its sides face unloaded chunks and are left out.
+    bool spans = sc.caster_mesh.size() == 8;
+    for (size_t v = 0; spans && v < 4; v++) {
+        uint32_t top = sc.caster_mesh[v];
+        int x = top & 0x1F, y = (top >> 5) & 0xFF, z = (top >> 13) & 0x1F;
+        spans = (x == 0 || x == 16) && (z == 0 || z == 16) && (y == 1 || y == 2);
+    }
+    tr.check(spans, "shadow_casters_greedy", "A flat solid floor should merge into one caster quad per side");
+    tr.check(sc.cutout_start == 512 * 12 && c->opaque_slots[0].used == sc.cutout_start + 6 * 12 &&
+             c->opaque_slots[0].cutout == sc.cutout_start && c->caster_slots[0].used == 8,
+             "shadow_cutouts_after_solid", "Alpha-tested faces should follow the solid ones in the opaque slot");
+
+    // A lone cube's caster quads must match its render faces corner for corner (same winding).
+    world->set_block({8, 40, 8}, 1);
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    const Subchunk& lone = c->subchunk_at(0, 2, 0);
+    const BlockType& cube = *world->block_types[1];
+    bool same = lone.caster_mesh.size() == 6 * 4;
+    for (int f = 0; same && f < 6; f++) {
+        for (int v = 0; v < 4; v++) {
+            uint32_t corner = lone.caster_mesh[f * 4 + v];
+            glm::ivec3 got(corner & 0x1F, (corner >> 5) & 0xFF, (corner >> 13) & 0x1F);
+            glm::ivec3 want = glm::ivec3(8, 40, 8) + (glm::ivec3(cube.faces[f].position[v * 3], cube.faces[f].position[v * 3 + 1],
+                                                                 cube.faces[f].position[v * 3 + 2]) + 8) / 16;
+            same = same && ivec_equal(got, want);
+        }
+    }
+    tr.check(same, "shadow_casters_winding", "Caster quads should keep the cube faces' corners and winding");
+}
+
+static void test_shadow_cascade_invalidation(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({1, 1, 1}, 1);
+    world->set_block({60, 1, 1}, 1);
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+
+    // Two cached cascades looking straight down: one over chunk (0,0), one over chunk (3,0).
+    glm::mat4 light_view = glm::lookAt(glm::vec3(8, 140, 8), glm::vec3(8, 0, 8), glm::vec3(0, 0, -1));
+    glm::mat4 proj = glm::ortho(-8.0f, 8.0f, -8.0f, 8.0f, 0.1f, 200.0f);
+    world->shadow_matrices = {proj * light_view, glm::translate(proj * light_view, glm::vec3(-48, 0, 0))};
+    world->shadow_cascades.assign(2, {});
+    for (auto& sc : world->shadow_cascades) {
+        sc.rendered = true;
+        sc.refit = sc.dirty = false;
+    }
+
+    world->set_block({2, 1, 1}, 1);
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    tr.check(world->shadow_cascades[0].dirty && !world->shadow_cascades[1].dirty, "shadow_cache_remesh",
+             "Only cascades covering a remeshed chunk should be queued for re-rendering");
+
+    Chunk* far_chunk = world->chunks[{3, 0, 0}];
+    world->chunks.erase({3, 0, 0});
+    world->chunk_pool.release(far_chunk);
+    tr.check(world->shadow_cascades[1].dirty, "shadow_cache_unload",
+             "Unloading a chunk should invalidate the cascades it cast into");
+
+    long step = Options::SHADOW_SUN_STEP_TICKS;
+    world->time = step * 10;
+    glm::vec3 at_step = world->get_light_direction();
+    world->time = step * 10 + step - 1;
+    bool held = world->get_light_direction() == at_step;
+    world->time = step * 11;
+    tr.check(held && world->get_light_direction() != at_step, "shadow_sun_quantised",
+             "The sun direction should only move once per step");
+}
+
+static void drain_light(World& world) {
+    const int unbounded = std::numeric_limits<int>::max();
+    while (!world.light_decrease_queue.empty() || !world.light_increase_queue.empty() ||
+           !world.skylight_decrease_queue.empty() || !world.skylight_increase_queue.empty()) {
+        world.propagate_decrease(false, unbounded);
+        world.propagate_increase(false, unbounded);
+        world.propagate_skylight_decrease(false, unbounded);
+        world.propagate_skylight_increase(false, unbounded);
+    }
+}
+
+static void test_batch_edit_matches_single_edits(TestRunner& tr) {
+    // A roof over a torch, then a hole punched into the roof and the torch removed.
+    std::vector<BlockEdit> build, punch;
+    for (int x = 0; x < 6; x++)
+        for (int z = 0; z < 6; z++) build.push_back({{x, 20, z}, 1});
+    build.push_back({{2, 18, 2}, 10});
+    punch.push_back({{3, 20, 3}, 0});
+    punch.push_back({{2, 18, 2}, 0});
+
+    auto single = build_test_world();
+    auto batched = build_test_world();
+    single->set_block({0, 0, 0}, 1);
+    batched->set_block({0, 0, 0}, 1);
+    drain_light(*single);
+    drain_light(*batched);
+
+    bool same = true;
+    for (const auto& edits : {build, punch}) {
+        for (const auto& e : edits) single->set_block(e.pos, e.number);
+        drain_light(*single);
+        batched->set_blocks(edits);
+        drain_light(*batched);
+        Chunk* a = single->chunks[{0, 0, 0}];
+        Chunk* b = batched->chunks[{0, 0, 0}];
+        same = same && std::memcmp(a->blocks, b->blocks, sizeof(a->blocks)) == 0 &&
+               std::memcmp(a->lightmap, b->lightmap, sizeof(a->lightmap)) == 0;
+    }
+    tr.check(same, "batch_light_matches", "Batched edits should light the world like the same edits one by one");
+    tr.check(batched->batch_depth == 0 && batched->batch_edits.empty(), "batch_committed",
+             "commit() should close the batch and clear pending edits");
+
+    // Background light work queued before the batch is left for the budgeted ticks.
+    glm::ivec3 pending{10, 60, 10};
+    batched->light_increase_queue.push_back({pending, 12});
+    batched->set_blocks(build);
+    tr.check(batched->light_increase_queue.size() == 1 && batched->light_increase_queue.front().first == pending &&
+             batched->get_light(pending + glm::ivec3(1, 0, 0)) == 0,
+             "batch_parks_background_light", "commit() should relight only its own edits");
+}
+
+static void test_emitter_index(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({3, 40, 5}, 10);
+    world->set_blocks(std::vector<BlockEdit>{{{7, 90, 9}, 10}, {{8, 90, 9}, 1}});
+    Chunk* c = world->chunks[{0, 0, 0}];
+    tr.check(c->subchunk_at(0, 2, 0).emitters.size() == 1 && c->subchunk_at(0, 5, 0).emitters.size() == 1,
+             "emitter_index_on_set", "Placed light blocks should be indexed in their subchunk");
+    world->set_block({3, 40, 5}, 1);
+    tr.check(c->subchunk_at(0, 2, 0).emitters.empty(), "emitter_index_on_remove",
+             "Replacing a light block should drop it from the index");
+
+    Save save(world.get());
+    save.path = "save_test_emitters";
+    save.save();
+
+    auto reloaded = build_test_world();
+    Save load(reloaded.get());
+    load.path = save.path;
+    load.load(0);
+    Chunk* r = reloaded->chunks[{0, 0, 0}];
+    std::vector<glm::ivec3> found;
+    r->for_each_emitter([&](glm::ivec3 lp) { found.push_back(lp); });
+    tr.check(found.size() == 1 && ivec_equal(found[0], {7, 90, 9}), "emitter_index_saved",
+             "The emitter index should round-trip through the save");
+    tr.check(reloaded->get_light({7, 90, 9}) == 15 && reloaded->get_light({6, 90, 9}) == 14,
+             "emitter_index_seeds_light", "Loading should light the world from the saved emitters");
+    std::filesystem::remove_all(save.path);
+}
+
+static void test_compressed_chunk_cache(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({3, 40, 5}, 10);
+    world->set_block({3, 41, 5}, 1);
+    drain_light(*world);
+    Chunk* c = world->chunks[{0, 0, 0}];
+
+    Chunk restored(world.get(), {0, 0, 0});
+    world->compressed_chunks.put(*c);
+    size_t packed = world->compressed_chunks.bytes_used();
+    bool ok = world->compressed_chunks.take({0, 0, 0}, restored);
+    tr.check(ok && packed > 0 && packed < sizeof(c->blocks) &&
+             std::memcmp(restored.blocks, c->blocks, sizeof(c->blocks)) == 0 &&
+             std::memcmp(restored.lightmap, c->lightmap, sizeof(c->lightmap)) == 0 &&
+             restored.subchunk_at(0, 2, 0).emitters.size() == 1,
+             "compressed_chunk_roundtrip", "Packed chunks should restore blocks, light and emitters exactly");
+
+    world->compressed_chunks.set_budget(packed - 1);
+    world->compressed_chunks.put(*c);
+    tr.check(world->compressed_chunks.size() == 0 && world->compressed_chunks.bytes_used() == 0,
+             "compressed_chunk_budget", "Entries over the memory budget should be evicted");
+}
+
+static void test_chunk_pool_recycles(TestRunner& tr) {
+    auto world = build_test_world();
+    world->set_block({3, 40, 5}, 10);
+    Chunk* c = world->chunks[{0, 0, 0}];
+    c->update_subchunk_meshes();
+    world->chunks.erase({0, 0, 0});
+    world->chunk_pool.release(c);
+
+    size_t allocations = world->chunk_pool.allocations;
+    Chunk* reused = world->chunk_pool.acquire({2, 0, -1});
+    const Subchunk& sc = reused->subchunk_at(0, 2, 0);
+    tr.check(reused == c && world->chunk_pool.allocations == allocations, "chunk_pool_reuse",
+             "Acquiring after a release should hand back the pooled chunk without allocating");
+    tr.check(ivec_equal(reused->chunk_position, {2, 0, -1}) && reused->blocks[3][40][5] == 0 && reused->lightmap[3][40][5] == 0 &&
+             reused->dirty_mask == 0 && !reused->modified && sc.emitters.empty() && !sc.has_mesh && sc.mesh.empty(),
+             "chunk_pool_reset", "A recycled chunk should come back empty at its new position");
+    world->chunk_pool.release(reused);
+
+    VertexBufferPool& vbos = world->vbo_pool;
+    VertexBufferPool::Buffer big = vbos.acquire(5000);
+    vbos.release(big);
+    VertexBufferPool::Buffer small = vbos.acquire(100);
+    tr.check(vbos.created == 1 && vbos.reallocated == 1 && small.capacity == big.capacity && small.capacity >= 5000,
+             "vbo_pool_reuse", "A released buffer with enough room should be reused without reallocating");
+}
+
+static void test_chunk_load_queue_order(TestRunner& tr) {
+    ChunkLoadQueue queue;
+    ChunkLoadQueue::Viewer viewer;
+    viewer.position = {8.0f, 80.0f, 8.0f};
+    viewer.has_view = true; // yaw 0 faces +x
+    queue.rescore(viewer);
+    for (glm::ivec3 pos : {glm::ivec3(-4, 0, 0), glm::ivec3(4, 0, 0), glm::ivec3(0, 0, 1), glm::ivec3(0, 0, 4)}) queue.push(pos);
+    bool deduped = !queue.push({4, 0, 0}) && queue.size() == 4;
+
+    std::vector<glm::ivec3> order;
+    glm::ivec3 pos;
+    while (queue.pop(pos)) order.push_back(pos);
+    tr.check(deduped, "load_queue_dedup", "Queuing a pending chunk twice should be ignored");
+    tr.check(order.size() == 4 && ivec_equal(order[0], {0, 0, 1}) && ivec_equal(order[1], {4, 0, 0}) &&
+             ivec_equal(order[3], {-4, 0, 0}) && !queue.contains({4, 0, 0}),
+             "load_queue_view_order", "The player's own chunks then chunks ahead of the view should load first");
+
+    for (glm::ivec3 p : {glm::ivec3(-4, 0, 0), glm::ivec3(4, 0, 0)}) queue.push(p);
+    viewer.velocity = {-30.0f, 0.0f, 0.0f};
+    queue.update_viewer(viewer);
+    tr.check(queue.rescores == 2 && queue.pop(pos) && ivec_equal(pos, {-4, 0, 0}), "load_queue_lookahead",
+             "Moving fast the other way should re-score and pull the chunks ahead of the player forward");
+
+    auto world = build_test_world();
+    Save save(world.get());
+    save.path = "save_test_streaming";
+    save.update_streaming({8.0f, 80.0f, 8.0f});
+    size_t queued = save.pending_chunk_count();
+    save.update_streaming({8.0f + CHUNK_WIDTH, 80.0f, 8.0f});
+    save.update_streaming({8.0f, 80.0f, 8.0f});
+    tr.check(queued > 0 && save.pending_chunk_count() == queued, "streaming_queue_dedup",
+             "Re-entering a chunk should neither duplicate nor lose pending loads");
+}
+
+static void test_render_order_incremental(TestRunner& tr) {
+    auto world = build_test_world();
+    for (int cx = -2; cx <= 2; cx++)
+        for (int cz = -2; cz <= 2; cz++) world->set_block({cx * CHUNK_WIDTH, 10, cz * CHUNK_LENGTH}, 1);
+
+    auto sorted_nearest_first = [&](const glm::vec3& eye) {
+        if (world->visible_chunks.size() != world->chunks.size()) return false;
+        float last = -1.0f;
+        for (Chunk* c : world->visible_chunks) {
+            glm::vec3 center = c->position + glm::vec3(CHUNK_WIDTH * 0.5f, CHUNK_HEIGHT * 0.5f, CHUNK_LENGTH * 0.5f);
+            float d = glm::dot(eye - center, eye - center);
+            if (d < last) return false;
+            last = d;
+        }
+        return true;
+    };
+
+    glm::vec3 eye(1.0f, 64.0f, 1.0f);
+    world->update_render_order(eye);
+    bool first = world->render_order_full_sorts == 1 && sorted_nearest_first(eye);
+
+    // Walk across the chunk without leaving it: fix-ups only
+    for (int i = 0; i < 13; i++) {
+        eye.x += 1.0f;
+        eye.z += 0.5f;
+        world->update_render_order(eye);
+    }
+    bool incremental = world->render_order_full_sorts == 1 && sorted_nearest_first(eye);
+
+    eye.x += CHUNK_WIDTH;
+    world->update_render_order(eye);
+    bool crossed = world->render_order_full_sorts == 2 && sorted_nearest_first(eye);
+
+    Chunk* far = world->visible_chunks.back();
+    world->remove_visible_chunk(far);
+    glm::ivec3 far_pos = world->get_chunk_pos(far->position);
+    world->chunks.erase(far_pos);
+    world->update_render_order(eye);
+    bool removed = world->render_order_full_sorts == 2 && sorted_nearest_first(eye);
+    world->chunks[far_pos] = far;
+
+    tr.check(first, "render_order_front_to_back", "Chunks should be ordered nearest first");
+    tr.check(incremental, "render_order_fixup", "Moving inside one chunk should keep the order without a full sort");
+    tr.check(crossed, "render_order_resort", "Crossing a chunk boundary should trigger a full sort");
+    tr.check(removed, "render_order_unload", "Unloading a chunk should keep the order without a full sort");
+}
+
+static void test_translucent_sorting(TestRunner& tr) {
+    std::vector<TranslucentQuad> line;
+    for (int i = 0; i < 300; i++) line.push_back({static_cast<int16_t>((i * 7 % 300) * 16), 0, 0, static_cast<uint32_t>(i)});
+    std::vector<uint32_t> order;
+    sort_back_to_front(line, {-2.0f, 0.0f, 0.0f}, order);
+    bool far_first = order.size() == line.size();
+    for (size_t i = 1; far_first && i < order.size(); i++) far_first = line[order[i - 1]].x > line[order[i]].x;
+    tr.check(far_first, "translucent_radix_order", "Quads should come out farthest first");
+
+    auto world = build_test_world();
+    world->block_types.resize(21);
+    world->block_types[20] = make_block_type(true, true, true); // Water-like
+    world->build_block_properties();
+    std::vector<BlockEdit> pool;
+    for (int x = 2; x < 10; x++)
+        for (int z = 2; z < 10; z++) pool.push_back({{x, 20, z}, 20});
+    world->set_blocks(pool);
+    Chunk* c = world->chunks[{0, 0, 0}];
+    c->update_subchunk_meshes();
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+
+    std::vector<TranslucentQuad> quads;
+    c->gather_translucent_quads(quads);
+    bool centroids = !quads.empty();
+    for (const TranslucentQuad& q : quads) {
+        // Face centres sit half a block (32/64) from a block centre on exactly one axis.
+        int off = (q.x % 64 != 0) + (q.y % 64 != 0) + (q.z % 64 != 0);
+        centroids = centroids && off == 1 && q.y >= 20 * 64 - 32 && q.y <= 20 * 64 + 32;
+    }
+    tr.check(centroids && c->translucent_generation != 0, "translucent_centroids",
+             "Uploaded translucent quads should be keyed by their face centres");
+
+    glm::vec3 eye(6.0f, 30.0f, 6.0f);
+    world->update_render_order(eye);
+    world->update_translucent_order(eye);
+    bool queued = c->sort_job != 0;
+    world->translucent_sorter.flush();
+    world->update_translucent_order(eye);
+    tr.check(queued && c->sort_job == 0 && c->sorted_generation == c->translucent_generation &&
+             c->translucent_index_count == quads.size() * 6,
+             "translucent_order_uploaded", "A finished sort should become the chunk's index order");
+
+    world->update_translucent_order(eye + glm::vec3(0.3f, 0.0f, 0.0f));
+    bool small_move_kept = c->sort_job == 0;
+    world->update_translucent_order(eye + glm::vec3(4.0f, 0.0f, 0.0f));
+    bool big_move_resorts = c->sort_job != 0;
+    world->translucent_sorter.flush();
+
+    world->set_block({5, 21, 5}, 20);
+    world->remesh_scheduler.run(std::numeric_limits<int64_t>::max());
+    world->update_translucent_order(eye);
+    // The in-flight result was for the old quads: dropped, and the chunk queued again.
+    bool stale_dropped = c->sort_job != 0 && c->sorted_generation != c->translucent_generation;
+    world->translucent_sorter.flush();
+    world->update_translucent_order(eye);
+    stale_dropped = stale_dropped && c->sorted_generation == c->translucent_generation;
+    tr.check(small_move_kept && big_move_resorts, "translucent_resort_threshold",
+             "Only a significant camera move should trigger a re-sort");
+    tr.check(stale_dropped, "translucent_stale_order", "An order sorted for old geometry must not be used");
+}
+
+static void test_gl_state_skips_redundant(TestRunner& tr) {
+    GLState::invalidate();
+    GLState::reset_stats();
+    GLState::bind_vertex_array(5);
+    GLState::bind_vertex_array(5);
+    GLState::use_program(3);
+    GLState::use_program(4);
+    GLState::use_program(4);
+    tr.check(GLState::stats().calls == 5 && GLState::stats().skipped == 2, "gl_state_bindings",
+             "Rebinding the bound program or vertex array should be skipped");
+
+    GLState::reset_stats();
+    GLState::enable(GL_BLEND);
+    GLState::enable(GL_BLEND);
+    GLState::disable(GL_BLEND);
+    GLState::depth_mask(false);
+    GLState::depth_mask(false);
+    tr.check(GLState::stats().calls == 5 && GLState::stats().skipped == 2, "gl_state_caps",
+             "Repeated enables and depth mask writes should be skipped, real changes kept");
+
+    GLuint vao = 5;
+    GLState::delete_vertex_arrays(1, &vao);
+    GLState::delete_program(4);
+    GLState::reset_stats();
+    GLState::bind_vertex_array(0);
+    GLState::bind_vertex_array(5);
+    GLState::use_program(0);
+    GLState::use_program(4);
+    tr.check(GLState::stats().skipped == 1, "gl_state_delete",
+             "Deleting a bound object should reset its binding to 0 so a reused name binds again");
+    GLState::invalidate();
+}
+
+static void test_dynamic_resolution_hysteresis(TestRunner& tr) {
+    DynamicResolution res;
+    bool steady = true;
+    for (int i = 0; i < 200; i++) {
+        // Noise around the target must never move the scale
+        steady &= !res.update(i % 2 ? 16.5f : 15.5f, 16.0f, 0.5f);
+    }
+    tr.check(steady && res.scale() == 1.0f, "dynres_hysteresis", "Frame times near the target should keep the scale");
+
+    int frames = 0;
+    while (!res.update(32.0f, 16.0f, 0.5f) && frames < 100) frames++;
+    float lowered = res.scale();
+    tr.check(frames + 1 == DynamicResolution::DOWN_FRAMES && lowered <= 0.8f && lowered >= 0.5f, "dynres_lowers",
+             "A sustained over-budget GPU time should drop the scale towards the pixel count that fits");
+
+    for (int i = 0; i < 100; i++) res.update(100.0f, 16.0f, 0.5f);
+    tr.check(res.scale() == 0.5f, "dynres_min_scale", "The scale should not go below the configured minimum");
+
+    frames = 0;
+    while (!res.update(4.0f, 16.0f, 0.5f) && frames < 1000) frames++;
+    tr.check(frames + 1 >= DynamicResolution::UP_FRAMES && frames < 1000 && std::fabs(res.scale() - 0.55f) < 1e-4f, "dynres_raises",
+             "Cheap frames should raise the scale one step at a time, only after a long run");
+}
+
 static void test_chunk_and_local_coords(TestRunner& tr) {
     auto world = build_test_world();
     tr.check(ivec_equal(world->get_chunk_pos({0, 0, 0}), {0, 0, 0}),
@@ -86,8 +723,8 @@ static void test_block_placement_and_updates(TestRunner& tr) {
              "block_written", "Block id should be stored inside the chunk");
     tr.check(it != world->chunks.end() && it->second->modified,
              "chunk_marked_modified", "Chunk should be flagged as modified after placement");
-    tr.check(it != world->chunks.end() && !it->second->chunk_update_queue.empty(),
-             "chunk_has_pending_updates", "Chunk update queue should contain subchunks to rebuild");
+    tr.check(it != world->chunks.end() && it->second->dirty_mask != 0 && world->dirty_chunks_head == it->second,
+             "chunk_has_pending_updates", "Chunk should have dirty subchunks and be on the world's dirty list");
 }
 
 static void test_light_propagation(TestRunner& tr) {
@@ -165,6 +802,28 @@ static void test_save_load_centers_on_player(TestRunner& tr) {
 
 int main() {
     TestRunner tr;
+    test_block_property_table(tr);
+    test_face_templates_baked(tr);
+    test_mesher_variants(tr);
+    test_mesh_input_hash(tr);
+    test_border_faces_wait_for_neighbours(tr);
+    test_cached_mesh_keeps_border_state(tr);
+    test_remesh_scheduler_priority(tr);
+    test_player_edit_fast_lane(tr);
+    test_fast_lane_takes_staged_sections(tr);
+    test_relayout_keeps_unchanged_sections(tr);
+    test_shadow_caster_culling(tr);
+    test_shadow_caster_stream(tr);
+    test_shadow_cascade_invalidation(tr);
+    test_batch_edit_matches_single_edits(tr);
+    test_emitter_index(tr);
+    test_compressed_chunk_cache(tr);
+    test_chunk_pool_recycles(tr);
+    test_chunk_load_queue_order(tr);
+    test_render_order_incremental(tr);
+    test_translucent_sorting(tr);
+    test_dynamic_resolution_hysteresis(tr);
+    test_gl_state_skips_redundant(tr);
     test_chunk_and_local_coords(tr);
     test_block_placement_and_updates(tr);
     test_light_propagation(tr);